@@ -3,9 +3,13 @@ import WSManager from "./wsManager.js";
 const INACTIVITY_DELAY = 10000; // ms
 const DEBOUNCE_DELAY = 100; // ms
 
-function formatDuration(ms) {
-    let milliseconds = ms % 1000;
-    let totalSeconds = Math.floor(ms / 1000);
+// Zeiten kommen in µs vom Gerät, gerundet wird erst hier auf die
+// Nachkommastellen, die die Fehlergrenze des Laufs noch trägt
+function formatDuration(us, decimals = 3) {
+    let unit = Math.pow(10, 6 - decimals); // µs pro angezeigter Einheit
+    let units = Math.round(us / unit);
+    let fraction = units % Math.pow(10, decimals);
+    let totalSeconds = Math.floor(units / Math.pow(10, decimals));
     let seconds = totalSeconds % 60;
     let totalMinutes = Math.floor(totalSeconds / 60);
     let minutes = totalMinutes % 60;
@@ -17,7 +21,8 @@ function formatDuration(ms) {
         parts.push(String(minutes).padStart(hours > 0 ? 2 : 1, "0"));
     parts.push(String(seconds).padStart(minutes > 0 || hours > 0 ? 2 : 1, "0"));
 
-    return parts.join(":") + "," + String(milliseconds).padStart(3, "0");
+    let text = parts.join(":");
+    return decimals > 0 ? text + "," + String(fraction).padStart(decimals, "0") : text;
 }
 
 // Initial formatting
@@ -80,7 +85,7 @@ document.addEventListener("DOMContentLoaded", function () {
     fetch("/api/last_time")
         .then((response) => response.json())
         .then((data) => {
-            zeitElement.textContent = formatDuration(data.lastTime);
+            zeitElement.textContent = formatDuration(data.lastTime, data.decimals);
         })
         .catch((err) => {
             console.log("Fehler beim Laden der letzten Zeit:", err);
@@ -104,7 +109,7 @@ document.addEventListener("DOMContentLoaded", function () {
             try {
                 let msg = JSON.parse(event.data);
                 if (msg.type === "lastTime") {
-                    zeitElement.textContent = formatDuration(Number(msg.value));
+                    zeitElement.textContent = formatDuration(Number(msg.value), msg.decimals);
                 }
                 if (msg.type === "laufCount") {
                     updateLaufstatus(Number(msg.value));
@@ -1,6 +1,11 @@
 #include <Sensor.h>
 #include <Arduino.h>
 #include <data.h>
+#include <freertos/queue.h>
+#include <atomic>
+#include <hal/gpio_ll.h>
+#include <triggerLogic.h>
+#include <trace.h>
 
 #ifndef TRIG_PIN
 #define TRIG_PIN 12
@@ -9,76 +14,255 @@
 #define ECHO_PIN 13
 #endif
 
-int cachedMinDistance = 2;   // Cache für bessere Performance
-int cachedMaxDistance = 100; // Cache für bessere Performance
+// Ohne Pin-Listen bleibt es beim einzelnen TRIG_PIN/ECHO_PIN-Paar
+#ifndef SENSOR_TRIG_PINS
+#define SENSOR_TRIG_PINS {TRIG_PIN}
+#endif
+#ifndef SENSOR_ECHO_PINS
+#define SENSOR_ECHO_PINS {ECHO_PIN}
+#endif
+
+// Maximale Wartezeit auf ein Echo (entspricht dem alten pulseIn-Timeout)
+#ifndef ECHO_TIMEOUT_US
+#define ECHO_TIMEOUT_US 20000UL
+#endif
+
+// Im DRAM: die Flanken-ISR liest die Tabelle auch während Flash-Schreibvorgängen
+// (NVS), bei abgeschaltetem Flash-Cache wäre ein Zugriff auf .rodata ein Absturz
+static DRAM_ATTR const uint8_t trigPins[SENSOR_CHANNELS] = SENSOR_TRIG_PINS;
+static DRAM_ATTR const uint8_t echoPins[SENSOR_CHANNELS] = SENSOR_ECHO_PINS;
+
+// Pro Kanal eigene Schwellen, eigener Filter und eigenes Echo-Timeout
+struct SensorChannel
+{
+    int minDistance;       // Cache für bessere Performance
+    int maxDistance;       // Cache für bessere Performance
+    uint32_t echoTimeoutUs; // Echo-Wartezeit, auf den relevanten Bereich begrenzt
+    DistanceFilter filter;
+};
+
+SensorChannel channels[SENSOR_CHANNELS];
+FilterConfig cachedFilterConfig = defaultFilterConfig(); // Nur der Sensor-Task
+
+// Neue Filter-Konfiguration aus anderen Tasks (Webserver): veröffentlicht unter filterMux,
+// übernommen und Filter zurückgesetzt erst im Sensor-Task zwischen zwei Samples
+static FilterConfig publishedFilterConfig = defaultFilterConfig();
+static portMUX_TYPE filterMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> filterConfigSeq{0};
+static uint32_t appliedFilterConfigSeq = 0;
+static volatile bool fullEchoRange[SENSOR_CHANNELS] = {false}; // Kalibrierung: volle Echo-Wartezeit
+
+// Echo-Wartezeit eines Kanals; während der Kalibrierung der volle Bereich,
+// sonst fiele ein Hintergrund jenseits der alten Max-Distanz als "kein Echo" aus
+static uint32_t echoWaitUs(uint8_t channel)
+{
+    return fullEchoRange[channel] ? ECHO_TIMEOUT_US : channels[channel].echoTimeoutUs;
+}
+
+// Fertiges Echo, von der ISR an den Sensor-Task übergeben
+struct EchoSample
+{
+    int64_t echoStartUs; // Steigende Flanke (esp_timer_get_time())
+    uint32_t pulseUs;    // Pulsbreite in µs
+};
 
-// Einfache Ultraschall-Messung ohne externe Bibliothek - optimiert für Geschwindigkeit
-float getDistanceCM()
+static QueueHandle_t echoQueue = NULL;
+static portMUX_TYPE echoMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t echoRiseUs[SENSOR_CHANNELS] = {0}; // 0 = keine steigende Flanke offen
+static volatile uint8_t activeChannel = 0;        // Gerade gefeuerter Kanal
+static int64_t lastPingUs = 0;                    // Letzter Trigger eines beliebigen Kanals
+
+// Flanken-ISR: Zeitstempel beider Flanken, fertiges Sample in die Queue.
+// Flanken fremder Kanäle (Übersprechen) werden verworfen.
+void IRAM_ATTR onEchoEdge(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    uint8_t channel = (uint8_t)(uintptr_t)arg;
+    bool level = gpio_ll_get_level(&GPIO, (gpio_num_t)echoPins[channel]) != 0; // Inline, kein Flash-Code
+
+    portENTER_CRITICAL_ISR(&echoMux);
+    int64_t riseUs = echoRiseUs[channel];
+    echoRiseUs[channel] = level ? now : 0;
+    portEXIT_CRITICAL_ISR(&echoMux);
+
+    if (level || riseUs == 0 || channel != activeChannel)
+        return;
+
+    EchoSample sample;
+    sample.echoStartUs = riseUs;
+    sample.pulseUs = (uint32_t)(now - riseUs);
+
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(echoQueue, &sample, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+// Ultraschall-Messung per Flanken-Interrupt: Der Task blockiert auf der Queue
+// statt in pulseIn() zu pollen, der Zeitstempel kommt direkt aus der ISR.
+// false = Ping ausgelassen, der Sensor meldet noch das Echo des letzten Pings.
+bool getDistanceCM(uint8_t channel, float &distance, int64_t &sampleTimeUs)
 {
-    digitalWrite(TRIG_PIN, LOW);
+    // Der HC-SR04 hält ECHO für den ganzen Laufweg high (ohne Echo ~38 ms) und
+    // ignoriert bis dahin jeden Trigger; echoTimeoutUs begrenzt nur die Auswertung
+    if (digitalRead(echoPins[channel]) == HIGH)
+        return false;
+
+#if SENSOR_CHANNELS > 1
+    // Übersprechen: Der Burst des vorigen Kanals ist für den ganzen physikalischen
+    // Laufweg unterwegs, auch wenn dessen Auswertung schon abgebrochen hat
+    if (channel != activeChannel &&
+        (esp_timer_get_time() - lastPingUs < (int64_t)ECHO_TIMEOUT_US || digitalRead(echoPins[activeChannel]) == HIGH))
+        return false;
+#endif
+
+    xQueueReset(echoQueue);
+    portENTER_CRITICAL(&echoMux);
+    activeChannel = channel;
+    echoRiseUs[channel] = 0; // Reste eines alten Echos verwerfen
+    portEXIT_CRITICAL(&echoMux);
+
+    uint8_t trigPin = trigPins[channel];
+    digitalWrite(trigPin, LOW);
     delayMicroseconds(2);
-    digitalWrite(TRIG_PIN, HIGH);
+    digitalWrite(trigPin, HIGH);
     delayMicroseconds(10);
-    digitalWrite(TRIG_PIN, LOW);
-
-    // Noch kürzerer Timeout für maximale Reaktionszeit
-    long duration = pulseIn(ECHO_PIN, HIGH, 20000); // 20ms Timeout
+    digitalWrite(trigPin, LOW);
+    int64_t triggerUs = esp_timer_get_time();
+    lastPingUs = triggerUs;
 
-    if (duration == 0)
-        return MAX_DISTANCE_CM;
+    EchoSample sample;
+    uint32_t timeoutUs = echoWaitUs(channel);
+    TickType_t waitTicks = pdMS_TO_TICKS(timeoutUs / 1000) + 1;
+    if (xQueueReceive(echoQueue, &sample, waitTicks) != pdTRUE || sample.pulseUs > timeoutUs)
+    {
+        sampleTimeUs = triggerUs;
+        distance = MAX_DISTANCE_CM;
+        return true;
+    }
 
-    // Optimierte Berechnung
-    return (duration * 0.017); // Direkte Berechnung: duration * 0.034 / 2
+    // Reflexionszeitpunkt liegt in der Mitte des Echo-Pulses
+    sampleTimeUs = sample.echoStartUs + sample.pulseUs / 2;
+    distance = sample.pulseUs * 0.017f; // Direkte Berechnung: duration * 0.034 / 2
+    return true;
 }
 
 void initSensor()
 {
-    pinMode(TRIG_PIN, OUTPUT);
-    pinMode(ECHO_PIN, INPUT);
+    echoQueue = xQueueCreate(4, sizeof(EchoSample));
+
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+    {
+        pinMode(trigPins[i], OUTPUT);
+        digitalWrite(trigPins[i], LOW);
+        pinMode(echoPins[i], INPUT);
+        attachInterruptArg(digitalPinToInterrupt(echoPins[i]), onEchoEdge, (void *)(uintptr_t)i, CHANGE);
+    }
+    Serial.printf("[SENSOR] %d Kanal/Kanäle initialisiert\n", SENSOR_CHANNELS);
 
-    // Lade Distanz-Werte in Cache für bessere Performance
+    // Lade Filter- und Distanz-Werte in Cache für bessere Performance
+    updateFilterCache();
     updateDistanceCache();
 }
 
-MeasureResult measure()
+// Sensor-Task: veröffentlichte Konfiguration übernehmen, nie mitten in evaluateSample
+static void applyPendingFilterConfig()
 {
-    MeasureResult res;
-    // Mikrosekunden-Genauigkeit für höchste Zeitpräzision
-    unsigned long startMicros = micros();
-    float dist = getDistanceCM();
-    res.time = startMicros / 1000; // Konvertierung zu Millisekunden
+    uint32_t seq = filterConfigSeq.load();
+    if (seq == appliedFilterConfigSeq)
+        return;
 
-    if (dist == 0)
+    portENTER_CRITICAL(&filterMux);
+    cachedFilterConfig = publishedFilterConfig;
+    portEXIT_CRITICAL(&filterMux);
+    appliedFilterConfigSeq = seq;
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
     {
-        dist = MAX_DISTANCE_CM;
+        resetFilter(channels[i].filter); // Fenstergröße kann sich geändert haben
     }
+}
+
+bool measure(uint8_t channel, MeasureResult &res)
+{
+    applyPendingFilterConfig();
 
-    // Optimierte Trigger-Erkennung
-    res.triggered = (dist >= cachedMinDistance && dist <= cachedMaxDistance);
+    SensorChannel &ch = channels[channel];
+    int64_t sampleTimeUs = 0;
+    float dist = MAX_DISTANCE_CM;
+    if (!getDistanceCM(channel, dist, sampleTimeUs))
+        return false;
+    recordTraceSample(channel, sampleTimeUs, dist);
 
-    // Debug nur bei Trigger-Ereignissen
-    if (res.triggered)
+    res = evaluateSample(ch.filter, cachedFilterConfig, channel, dist, sampleTimeUs, ch.minDistance, ch.maxDistance);
+    return true;
+}
+
+uint8_t getSensorChannelCount()
+{
+    return SENSOR_CHANNELS;
+}
+
+uint16_t getMinSensorPeriodMs()
+{
+    // Echo-Wartezeit plus 1 ms für Trigger und Auswertung; mit mehreren Kanälen
+    // liegt zwischen zwei Kanälen die volle physikalische Echo-Zeit
+    uint32_t waitUs = SENSOR_CHANNELS > 1 ? ECHO_TIMEOUT_US : 0;
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
     {
-        Serial.printf("Sensor TRIGGER: %.1fcm (Min:%d Max:%d)\n", dist, cachedMinDistance, cachedMaxDistance);
+        if (echoWaitUs(i) > waitUs)
+            waitUs = echoWaitUs(i);
     }
-
-    return res;
+    return (uint16_t)((waitUs + 999) / 1000 + 1);
 }
 
 void updateDistanceCache()
 {
-    // Verwende die Funktionen aus data.h für bessere Cache-Synchronisation
-    cachedMinDistance = getMinDistance();
-    cachedMaxDistance = getMaxDistance();
-    Serial.printf("[SENSOR_CACHE] Cache aktualisiert: Min:%d Max:%d\n", cachedMinDistance, cachedMaxDistance);
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+    {
+        SensorChannel &ch = channels[i];
+        // Verwende die Funktionen aus data.h für bessere Cache-Synchronisation
+        ch.minDistance = getMinDistance(i);
+        ch.maxDistance = getMaxDistance(i);
+
+        // Echos jenseits von Max + Hysterese + Reserve ändern keine Entscheidung
+        uint32_t rangeUs = (uint32_t)((ch.maxDistance + getCurrentFilterConfig().hysteresisCm + 30) / 0.017f);
+        ch.echoTimeoutUs = rangeUs < ECHO_TIMEOUT_US ? rangeUs : ECHO_TIMEOUT_US;
+
+        Serial.printf("[SENSOR_CACHE] Kanal %d: Min:%d Max:%d Echo-Timeout:%luus\n", i, ch.minDistance, ch.maxDistance, (unsigned long)ch.echoTimeoutUs);
+    }
+}
+
+void updateFilterCache()
+{
+    FilterConfig cfg = getFilterConfig();
+    portENTER_CRITICAL(&filterMux);
+    publishedFilterConfig = cfg;
+    portEXIT_CRITICAL(&filterMux);
+    filterConfigSeq++; // Der Sensor-Task übernimmt vor dem nächsten Sample
+    Serial.printf("[SENSOR_CACHE] Filter aktualisiert: %s, Fenster:%d, K:%.1f, Hysterese:%.1fcm, Bestätigung:%d\n",
+                  filterModeToString(cfg.mode), cfg.window, cfg.hampelK, cfg.hysteresisCm, cfg.confirmSamples);
+}
+
+void setFullEchoRange(uint8_t channel, bool full)
+{
+    if (channel < SENSOR_CHANNELS)
+        fullEchoRange[channel] = full;
+}
+
+FilterConfig getCurrentFilterConfig()
+{
+    portENTER_CRITICAL(&filterMux);
+    FilterConfig cfg = publishedFilterConfig;
+    portEXIT_CRITICAL(&filterMux);
+    return cfg;
 }
 
-int getCurrentMinDistance()
+int getCurrentMinDistance(uint8_t channel)
 {
-    return cachedMinDistance;
+    return channel < SENSOR_CHANNELS ? channels[channel].minDistance : 0;
 }
 
-int getCurrentMaxDistance()
+int getCurrentMaxDistance(uint8_t channel)
 {
-    return cachedMaxDistance;
+    return channel < SENSOR_CHANNELS ? channels[channel].maxDistance : 0;
 }
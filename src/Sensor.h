@@ -1,18 +1,31 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <stdint.h>
+#include <sensorFilter.h>
+
 #ifndef COOLDOWN_MS
 #define COOLDOWN_MS 3000UL
 #endif
+#define COOLDOWN_US ((int64_t)COOLDOWN_MS * 1000)
 
-#ifndef MAX_DISTANCE_CM
-#define MAX_DISTANCE_CM 400.0f
+// Anzahl Ultraschall-Kanäle pro Station, Pins als Listen per Build-Flag:
+//   -DSENSOR_CHANNELS=2 '-DSENSOR_TRIG_PINS={12,14}' '-DSENSOR_ECHO_PINS={13,27}'
+#define SENSOR_CHANNELS_MAX 4
+#ifndef SENSOR_CHANNELS
+#define SENSOR_CHANNELS 1
 #endif
+static_assert(SENSOR_CHANNELS >= 1 && SENSOR_CHANNELS <= SENSOR_CHANNELS_MAX, "SENSOR_CHANNELS muss zwischen 1 und SENSOR_CHANNELS_MAX liegen");
 
 struct MeasureResult
 {
-    unsigned long time;
-    bool triggered;
+    int64_t time;        // Zeitpunkt der Messung (µs, getTimeUs())
+    int64_t triggerTime; // Erster Roh-Treffer der aktuellen Auslösung (µs)
+    int64_t triggerErrorUs; // Abtastbedingte Unsicherheit von triggerTime (µs), -1 = unbekannt
+    float distance;            // Rohdistanz in cm
+    bool triggered;            // Gefilterte Entscheidung
+    bool echo;                 // false = Timeout, distance ist MAX_DISTANCE_CM
+    uint8_t channel;           // Gemessener Kanal
 };
 
 enum LichtschrankeStatus
@@ -23,14 +36,90 @@ enum LichtschrankeStatus
     STATUS_TRIGGERED_IN_COOLDOWN
 };
 
+#define STATUS_COUNT 4
+
+// Ziel-Abtastperioden je Status in ms (feste Deadlines, nicht Pausen)
+#ifndef SENSOR_PERIOD_NORMAL_MS
+#define SENSOR_PERIOD_NORMAL_MS 10
+#endif
+#ifndef SENSOR_PERIOD_TRIGGERED_MS
+#define SENSOR_PERIOD_TRIGGERED_MS 5
+#endif
+#ifndef SENSOR_PERIOD_COOLDOWN_MS
+#define SENSOR_PERIOD_COOLDOWN_MS 10
+#endif
+#ifndef SENSOR_PERIOD_TRIGGERED_IN_COOLDOWN_MS
+#define SENSOR_PERIOD_TRIGGERED_IN_COOLDOWN_MS 5
+#endif
+
+struct SensorPeriods
+{
+    uint16_t periodMs[STATUS_COUNT]; // Index = LichtschrankeStatus
+};
+
+// Jitter-Histogramm: |Ist-Periode - Soll-Periode|, Grenzen in µs
+#define JITTER_BUCKETS 7
+const uint32_t JITTER_BUCKET_LIMITS_US[JITTER_BUCKETS - 1] = {100, 250, 500, 1000, 2000, 5000};
+
+struct SensorTimingStats
+{
+    uint32_t samples;
+    uint32_t missedDeadlines;
+    int64_t periodSumUs;
+    int64_t minPeriodUs;
+    int64_t maxPeriodUs;
+    int64_t maxJitterUs;
+    int64_t maxTriggerHandlingUs;     // Erkennung bis Ende der Trigger-Behandlung im Sensor-Task
+    int64_t maxTriggerToNextSampleUs; // Erkennung bis zur nächsten Messung, ohne den Periodenschlaf
+    uint32_t jitterHistogram[JITTER_BUCKETS];
+};
+
+// Zustand eines Kanals, im Sensor-Pfad gezählt (seit Start bzw. Reset)
+#define HEALTH_DISTANCE_BUCKET_CM 25
+#define HEALTH_DISTANCE_BUCKETS ((int)(MAX_DISTANCE_CM / HEALTH_DISTANCE_BUCKET_CM) + 1) // letzter = kein Echo
+
+struct SensorHealthStats
+{
+    uint32_t samples;
+    uint32_t timeouts;           // Kein Echo innerhalb des Timeouts
+    uint32_t skippedPings;       // Nicht gefeuert, ECHO war vom letzten Ping noch high
+    uint32_t cooldownRejections; // Auslösungen, die der Cooldown verworfen hat
+    float samplesPerSecond;      // Über das letzte Fenster (~1 s)
+    uint32_t windowSamples;
+    int64_t windowStartUs;
+    int64_t lastSampleUs;
+    int64_t statusTimeUs[STATUS_COUNT]; // Verweildauer je LichtschrankeStatus
+    uint32_t distanceHistogram[HEALTH_DISTANCE_BUCKETS];
+};
+
 void initSensor();
 
-MeasureResult measure();
+// Feuert genau einen Kanal; die Kanäle werden vom Sensor-Task reihum gemessen,
+// zwischen zwei Kanälen liegt mindestens ECHO_TIMEOUT_US (Übersprechen).
+// false = Ping ausgelassen (ECHO noch high oder Burst des vorigen Kanals
+// noch unterwegs), res unverändert
+bool measure(uint8_t channel, MeasureResult &res);
+
+uint8_t getSensorChannelCount();
+
+// Kürzeste sinnvolle Abtastperiode: eine Messung wartet bis zum Echo-Timeout,
+// mehrere Kanäle zusätzlich die volle Echo-Zeit des vorigen Kanals
+uint16_t getMinSensorPeriodMs();
 
 void updateDistanceCache();
 
-int getCurrentMinDistance();
+// Kalibrierung: mit voller Echo-Wartezeit (ECHO_TIMEOUT_US) messen statt bis
+// Max-Distanz; zurück erst, wenn das Ergebnis die Max-Distanz gesetzt hat
+void setFullEchoRange(uint8_t channel, bool full);
+
+int getCurrentMinDistance(uint8_t channel = 0);
+
+int getCurrentMaxDistance(uint8_t channel = 0);
+
+// Aus beliebigem Task: neue Filter-Konfiguration veröffentlichen; der Sensor-Task
+// übernimmt sie und setzt die Filter zwischen zwei Samples zurück
+void updateFilterCache();
 
-int getCurrentMaxDistance();
+FilterConfig getCurrentFilterConfig();
 
 #endif
\ No newline at end of file
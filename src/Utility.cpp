@@ -226,21 +226,21 @@ void printDeviceLists()
     Serial.println("\nEntdeckte Geräte:");
     for (const auto &dev : getDiscoveredDevices())
     {
-        Serial.printf("%s - Rolle: %s, Online: %s, Offset: %ld ms\n",
+        Serial.printf("%s - Rolle: %s, Online: %s, Offset: %lld us\n",
                       macToString(dev.mac).c_str(),
                       roleToString(dev.role).c_str(),
                       dev.isOnline ? "Ja" : "Nein",
-                      dev.timeOffset);
+                      (long long)dev.timeOffset);
     }
 
     Serial.println("\nGespeicherte Geräte:");
     for (const auto &dev : getSavedDevices())
     {
-        Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X - Rolle: %s, Online: %s, Offset: %ld ms\n",
+        Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X - Rolle: %s, Online: %s, Offset: %lld us\n",
                       dev.mac[0], dev.mac[1], dev.mac[2], dev.mac[3], dev.mac[4], dev.mac[5],
                       roleToString(dev.role).c_str(),
                       dev.isOnline ? "Ja" : "Nein",
-                      dev.timeOffset);
+                      (long long)dev.timeOffset);
     }
     Serial.println("=====================\n");
 }
@@ -13,7 +13,7 @@ struct CustomChar
 };
 
 const uint8_t CHAR_BUFFER_SIZE = 8;
-const uint8_t TIME_STRING_BUFFER_SIZE = 6;
+const uint8_t TIME_STRING_BUFFER_SIZE = 7; // "59.999" + Nullterminator
 const uint8_t MINUTES_STRING_SIZE = 3;
 const uint8_t SECONDS_STRING_SIZE = 3;
 const uint8_t HUNDREDTHS_STRING_SIZE = 3;
@@ -144,13 +144,24 @@ void clearRemainingColumns(uint8_t startCol)
     }
 }
 
-void displaySecondsAndMilliseconds(unsigned long time, uint8_t &col)
+// Nachkommastellen des Formats auf decimals kürzen; die Zeit ist bereits gerundet
+static unsigned long fractionDigits(unsigned long time, uint8_t decimals)
+{
+    unsigned long fraction = time % 1000;
+    for (uint8_t i = decimals; i < 3; i++)
+        fraction /= 10;
+    return fraction;
+}
+
+void displaySecondsAndMilliseconds(unsigned long time, uint8_t &col, uint8_t decimals)
 {
     unsigned long seconds = time / 1000;
-    unsigned long milliseconds = time % 1000;
 
     char timeStr[TIME_STRING_BUFFER_SIZE];
-    sprintf(timeStr, "%02lu.%03lu", seconds, milliseconds);
+    if (decimals > 0)
+        sprintf(timeStr, "%02lu.%0*lu", seconds, decimals, fractionDigits(time, decimals));
+    else
+        sprintf(timeStr, "%02lu", seconds);
 
     for (uint8_t i = 0; timeStr[i] != '\0'; i++)
     {
@@ -161,14 +172,16 @@ void displaySecondsAndMilliseconds(unsigned long time, uint8_t &col)
     }
 }
 
-void displayMinutesSecondsHundredths(unsigned long time, uint8_t &col)
+void displayMinutesSecondsHundredths(unsigned long time, uint8_t &col, uint8_t decimals)
 {
     unsigned long minutes = time / 60000;
     unsigned long seconds = (time % 60000) / 1000;
-    unsigned long hundredths = (time % 1000) / 10;
 
     char timeStr[10];
-    sprintf(timeStr, "%lu:%02lu.%02lu", minutes, seconds, hundredths);
+    if (decimals > 0)
+        sprintf(timeStr, "%lu:%02lu.%0*lu", minutes, seconds, decimals, fractionDigits(time, decimals));
+    else
+        sprintf(timeStr, "%lu:%02lu", minutes, seconds);
 
     for (uint8_t i = 0; timeStr[i] != '\0'; i++)
     {
@@ -189,14 +202,16 @@ void displayMinutesSecondsHundredths(unsigned long time, uint8_t &col)
     }
 }
 
-void displayMinutesSecondsTenths(unsigned long time, uint8_t &col)
+void displayMinutesSecondsTenths(unsigned long time, uint8_t &col, uint8_t decimals)
 {
     unsigned long minutes = time / 60000;
     unsigned long seconds = (time % 60000) / 1000;
-    unsigned long tenths = (time % 1000) / 100;
 
     char timeStr[10];
-    sprintf(timeStr, "%02lu:%02lu.%lu", minutes, seconds, tenths);
+    if (decimals > 0)
+        sprintf(timeStr, "%02lu:%02lu.%lu", minutes, seconds, fractionDigits(time, 1));
+    else
+        sprintf(timeStr, "%02lu:%02lu", minutes, seconds);
 
     for (uint8_t i = 0; timeStr[i] != '\0'; i++)
     {
@@ -298,21 +313,41 @@ void matrixShowString(const char *text)
     clearRemainingColumns(col);
 }
 
-void matrixShowTime(unsigned long time)
+// Höchstens so viele Nachkommastellen wie das Format fasst, gerundet wie in app.js
+static uint8_t formatDecimals(unsigned long time)
+{
+    return time < 60000 ? 3 : (time < 600000 ? 2 : 1);
+}
+
+static unsigned long roundToDecimals(unsigned long time, uint8_t decimals)
+{
+    unsigned long unit = 1;
+    for (uint8_t i = decimals; i < 3; i++)
+        unit *= 10;
+    return (time + unit / 2) / unit * unit;
+}
+
+void matrixShowTime(unsigned long time, uint8_t decimals)
 {
     uint8_t col = 0;
 
+    if (decimals > formatDecimals(time))
+        decimals = formatDecimals(time);
+    time = roundToDecimals(time, decimals);
+    if (decimals > formatDecimals(time))
+        decimals = formatDecimals(time); // Rundung über eine Formatgrenze (59,9996 s)
+
     if (time < 60000)
     {
-        displaySecondsAndMilliseconds(time, col);
+        displaySecondsAndMilliseconds(time, col, decimals);
     }
     else if (time < 600000)
     {
-        displayMinutesSecondsHundredths(time, col);
+        displayMinutesSecondsHundredths(time, col, decimals);
     }
     else if (time < 3600000)
     {
-        displayMinutesSecondsTenths(time, col);
+        displayMinutesSecondsTenths(time, col, decimals);
     }
     else
     {
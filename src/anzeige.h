@@ -23,13 +23,14 @@ void initMatrix();
 void matrixWipeAnimation();
 
 void matrixShowString(const char *text);
-void matrixShowTime(unsigned long time);
+// time in ms; decimals = Nachkommastellen, die die Fehlergrenze trägt (durationDecimals)
+void matrixShowTime(unsigned long time, uint8_t decimals = 3);
 
 void writeCharToMatrix(char c, uint8_t preferredWidth, uint8_t &col, bool addSpace = true);
 void writeStringToMatrix(const char *str, uint8_t preferredWidth, uint8_t &col, bool addSpaceBetweenChars = true);
 void clearRemainingColumns(uint8_t startCol);
-void displaySecondsAndMilliseconds(unsigned long time, uint8_t &col);
-void displayMinutesSecondsHundredths(unsigned long time, uint8_t &col);
-void displayMinutesSecondsTenths(unsigned long time, uint8_t &col);
+void displaySecondsAndMilliseconds(unsigned long time, uint8_t &col, uint8_t decimals = 3);
+void displayMinutesSecondsHundredths(unsigned long time, uint8_t &col, uint8_t decimals = 2);
+void displayMinutesSecondsTenths(unsigned long time, uint8_t &col, uint8_t decimals = 1);
 
 #endif
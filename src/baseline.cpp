@@ -0,0 +1,152 @@
+#include <baseline.h>
+#include <string.h>
+#include <math.h>
+
+void resetCalibration(BaselineCalibration &c)
+{
+    memset(&c, 0, sizeof(c));
+}
+
+void addCalibrationSample(BaselineCalibration &c, float dist)
+{
+    c.samples++;
+    if (dist >= MAX_DISTANCE_CM || dist <= 0.0f)
+        return;
+
+    int bin = (int)(dist / BASELINE_BIN_CM);
+    if (bin >= BASELINE_BINS)
+        bin = BASELINE_BINS - 1;
+    if (c.histogram[bin] < UINT16_MAX)
+        c.histogram[bin]++;
+
+    c.echoes++;
+}
+
+// Untere Bin-Grenze des Quantils q über die Echo-Samples
+static float histogramQuantile(const BaselineCalibration &c, float q)
+{
+    uint32_t target = (uint32_t)(c.echoes * q);
+    uint32_t sum = 0;
+    for (int i = 0; i < BASELINE_BINS; i++)
+    {
+        sum += c.histogram[i];
+        if (sum > target)
+            return (float)(i * BASELINE_BIN_CM);
+    }
+    return MAX_DISTANCE_CM;
+}
+
+// Streuung des nächsten Reflektors: MAD der Echos innerhalb von BASELINE_CLUSTER_CM
+// um das Quantil. Weitere Reflektoren (Wand hinter dem Pfosten) blähen sie nicht auf.
+static float clusterNoise(const BaselineCalibration &c, float backgroundCm)
+{
+    int first = (int)((backgroundCm - BASELINE_CLUSTER_CM) / BASELINE_BIN_CM);
+    int last = (int)((backgroundCm + BASELINE_CLUSTER_CM) / BASELINE_BIN_CM);
+    if (first < 0)
+        first = 0;
+    if (last > BASELINE_BINS - 1)
+        last = BASELINE_BINS - 1;
+
+    uint32_t total = 0;
+    for (int i = first; i <= last; i++)
+        total += c.histogram[i];
+    if (total == 0)
+        return 0.0f;
+
+    // Median des Clusters (Bin-Mitte)
+    uint32_t sum = 0;
+    int medianBin = first;
+    for (int i = first; i <= last; i++)
+    {
+        sum += c.histogram[i];
+        if (sum * 2 >= total)
+        {
+            medianBin = i;
+            break;
+        }
+    }
+
+    // Median der Abstände zum Median-Bin, in ganzen Bins nach außen gezählt
+    sum = c.histogram[medianBin];
+    int radius = 0;
+    while (sum * 2 < total)
+    {
+        radius++;
+        if (medianBin - radius >= first)
+            sum += c.histogram[medianBin - radius];
+        if (medianBin + radius <= last)
+            sum += c.histogram[medianBin + radius];
+    }
+
+    // 1,4826 * MAD entspricht bei Normalverteilung der Standardabweichung;
+    // unter einer Bin-Breite ist die Auflösung erreicht
+    float mad = radius * BASELINE_BIN_CM;
+    if (mad < BASELINE_BIN_CM * 0.5f)
+        mad = BASELINE_BIN_CM * 0.5f;
+    return 1.4826f * mad;
+}
+
+BaselineResult deriveThresholds(const BaselineCalibration &c, int minDistance)
+{
+    BaselineResult r;
+    memset(&r, 0, sizeof(r));
+    r.minDistance = minDistance;
+
+    if (c.samples < BASELINE_MIN_SAMPLES)
+        return r;
+
+    r.echoRatio = (float)c.echoes / c.samples;
+
+    // Überwiegend kein Echo: nichts im Messbereich, volle Reichweite nutzbar
+    if (r.echoRatio < 0.5f)
+    {
+        r.ok = true;
+        r.openLane = true;
+        r.backgroundCm = MAX_DISTANCE_CM;
+        r.maxDistance = BASELINE_THRESHOLD_LIMIT_CM;
+        return r;
+    }
+
+    r.backgroundCm = histogramQuantile(c, 0.05f);
+    r.noiseCm = clusterNoise(c, r.backgroundCm);
+
+    float margin = BASELINE_MARGIN_SIGMA * r.noiseCm;
+    if (margin < BASELINE_MIN_MARGIN_CM)
+        margin = BASELINE_MIN_MARGIN_CM;
+
+    int maxDistance = (int)floorf(r.backgroundCm - margin);
+    if (maxDistance > BASELINE_THRESHOLD_LIMIT_CM)
+        maxDistance = BASELINE_THRESHOLD_LIMIT_CM;
+    r.maxDistance = maxDistance;
+
+    // Hintergrund zu nah oder zu unruhig: kein sinnvoller Trigger-Bereich
+    r.ok = maxDistance >= minDistance + BASELINE_MIN_SPAN_CM;
+    return r;
+}
+
+void resetDrift(BaselineDrift &d, float backgroundCm)
+{
+    d.backgroundCm = backgroundCm;
+    d.averageCm = backgroundCm;
+    d.samples = 0;
+}
+
+bool trackDrift(BaselineDrift &d, float dist, float &shiftCm)
+{
+    if (d.backgroundCm <= 0.0f || d.backgroundCm >= MAX_DISTANCE_CM || dist >= MAX_DISTANCE_CM)
+        return false;
+
+    // Nur Werte nahe am bekannten Hintergrund: Passanten verschieben nichts
+    if (fabsf(dist - d.averageCm) > 4.0f * BASELINE_DRIFT_CM)
+        return false;
+
+    // Exponentieller Mittelwert, Zeitkonstante ~1000 Samples
+    d.averageCm += (dist - d.averageCm) / 1000.0f;
+    d.samples++;
+
+    if (d.samples < 1000)
+        return false;
+
+    shiftCm = d.averageCm - d.backgroundCm;
+    return fabsf(shiftCm) > BASELINE_DRIFT_CM;
+}
@@ -0,0 +1,71 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <stdint.h>
+#include <sensorFilter.h>
+
+// Histogramm der Leer-Bahn über den ganzen Messbereich
+#define BASELINE_BIN_CM 2
+#define BASELINE_BINS ((int)(MAX_DISTANCE_CM / BASELINE_BIN_CM) + 1)
+
+#ifndef BASELINE_CALIBRATION_MS
+#define BASELINE_CALIBRATION_MS 5000
+#endif
+#ifndef BASELINE_MARGIN_SIGMA
+#define BASELINE_MARGIN_SIGMA 4.0f // Sicherheitsabstand in Rausch-Standardabweichungen
+#endif
+#ifndef BASELINE_CLUSTER_CM
+#define BASELINE_CLUSTER_CM 20 // Echos um das Quantil, die zum nächsten Reflektor zählen
+#endif
+#ifndef BASELINE_MIN_MARGIN_CM
+#define BASELINE_MIN_MARGIN_CM 10.0f
+#endif
+#ifndef BASELINE_THRESHOLD_LIMIT_CM
+#define BASELINE_THRESHOLD_LIMIT_CM 200 // Obergrenze wie bei /set_max_distance
+#endif
+#ifndef BASELINE_DRIFT_CM
+#define BASELINE_DRIFT_CM 3.0f // Ab dieser Hintergrund-Verschiebung wird nachgeführt
+#endif
+#define BASELINE_MIN_SAMPLES 50
+#define BASELINE_MIN_SPAN_CM 10 // Mindestbreite des Trigger-Bereichs
+
+// Messwerte der leeren Bahn während der Kalibrierung
+struct BaselineCalibration
+{
+    uint16_t histogram[BASELINE_BINS];
+    uint32_t samples;
+    uint32_t echoes; // Samples mit Echo (< MAX_DISTANCE_CM)
+};
+
+struct BaselineResult
+{
+    bool ok;
+    bool openLane;      // Kein Hintergrund-Echo: Schwelle an die Obergrenze
+    float backgroundCm; // Nächster typischer Hintergrund (5%-Quantil)
+    float noiseCm;      // Streuung des nächsten Reflektors (MAD, als Standardabweichung skaliert)
+    float echoRatio;
+    int minDistance;
+    int maxDistance;
+};
+
+// Langsame Nachführung des Hintergrunds im Leerlauf
+struct BaselineDrift
+{
+    float backgroundCm; // Stand der letzten Kalibrierung/Nachführung (0 = unbekannt)
+    float averageCm;    // Gleitender Mittelwert seitdem
+    uint32_t samples;
+};
+
+void resetCalibration(BaselineCalibration &c);
+void addCalibrationSample(BaselineCalibration &c, float dist);
+
+// Leitet aus der Verteilung den Trigger-Bereich ab; minDistance bleibt die Blindzone
+BaselineResult deriveThresholds(const BaselineCalibration &c, int minDistance);
+
+void resetDrift(BaselineDrift &d, float backgroundCm);
+
+// Nimmt ein Leerlauf-Sample auf; liefert true, sobald der Hintergrund um mehr als
+// BASELINE_DRIFT_CM gewandert ist. shiftCm enthält dann die Verschiebung.
+bool trackDrift(BaselineDrift &d, float dist, float &shiftCm);
+
+#endif
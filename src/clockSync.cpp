@@ -0,0 +1,168 @@
+#include <clockSync.h>
+#include <string.h>
+#include <math.h>
+
+void resetClockModel(ClockModel &m)
+{
+    memset(&m, 0, sizeof(m));
+}
+
+void startClockBurst(ClockBurst &b, uint32_t sequence)
+{
+    memset(&b, 0, sizeof(b));
+    b.sequence = sequence;
+}
+
+bool addClockExchange(ClockBurst &b, int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+{
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (t4 < t1 || t3 < t2 || delay < 0)
+        return false;
+
+    ClockSample s;
+    s.localUs = t1 + (t4 - t1) / 2;
+    s.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+    s.delayUs = delay;
+
+    // Minimum-Laufzeit-Filter: Warteschlangen im Funk verlängern nur, verkürzen nie
+    if (b.received == 0 || s.delayUs < b.best.delayUs)
+        b.best = s;
+    b.received++;
+    return true;
+}
+
+bool finishClockBurst(ClockModel &m, const ClockBurst &b)
+{
+    if (b.received == 0)
+        return false;
+
+    m.history[m.historyHead] = b.best;
+    m.historyHead = (m.historyHead + 1) % CLOCK_HISTORY;
+    if (m.historyCount < CLOCK_HISTORY)
+        m.historyCount++;
+    m.bursts++;
+
+    // Nur Samples nahe der kleinsten Laufzeit gehen in die Anpassung ein
+    int64_t minDelay = m.history[0].delayUs;
+    int64_t newest = b.best.localUs;
+    int64_t oldest = newest;
+    for (uint8_t i = 0; i < m.historyCount; i++)
+    {
+        if (m.history[i].delayUs < minDelay)
+            minDelay = m.history[i].delayUs;
+    }
+
+    double sumX = 0, sumY = 0;
+    int n = 0;
+    for (uint8_t i = 0; i < m.historyCount; i++)
+    {
+        const ClockSample &s = m.history[i];
+        if (s.delayUs > 2 * minDelay + 500)
+            continue;
+        sumX += (double)(s.localUs - newest);
+        sumY += (double)(s.offsetUs - b.best.offsetUs);
+        if (s.localUs < oldest)
+            oldest = s.localUs;
+        n++;
+    }
+    double meanX = sumX / n, meanY = sumY / n;
+
+    double sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < m.historyCount; i++)
+    {
+        const ClockSample &s = m.history[i];
+        if (s.delayUs > 2 * minDelay + 500)
+            continue;
+        double dx = (double)(s.localUs - newest) - meanX;
+        double dy = (double)(s.offsetUs - b.best.offsetUs) - meanY;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+
+    // Drift (Steigung) erst schätzen, wenn die Samples weit genug auseinander liegen
+    double slope = 0.0;
+    bool skewValid = false;
+    if (n >= 2 && newest - oldest >= CLOCK_MIN_SKEW_SPAN_US && sxx > 0)
+    {
+        slope = sxy / sxx;
+        if (fabs(slope * 1e6) <= CLOCK_MAX_SKEW_PPM)
+            skewValid = true;
+        else
+            slope = 0.0;
+    }
+
+    // Gerade am neuesten Sample verankern
+    double intercept = meanY - slope * meanX;
+    double residual = 0;
+    for (uint8_t i = 0; i < m.historyCount; i++)
+    {
+        const ClockSample &s = m.history[i];
+        if (s.delayUs > 2 * minDelay + 500)
+            continue;
+        double x = (double)(s.localUs - newest);
+        double r = (double)(s.offsetUs - b.best.offsetUs) - (intercept + slope * x);
+        residual += r * r;
+    }
+    double rms = n > 2 ? sqrt(residual / (n - 2)) : 0.0;
+
+    m.valid = true;
+    m.refLocalUs = newest;
+    m.offsetUs = b.best.offsetUs + (int64_t)llround(intercept);
+    m.skewPpm = slope * 1e6;
+    m.skewValid = skewValid;
+    m.skewErrorPpm = (skewValid && n > 2) ? rms / sqrt(sxx) * 1e6 : CLOCK_DEFAULT_DRIFT_PPM;
+    if (skewValid && m.skewErrorPpm < 1.0)
+        m.skewErrorPpm = 1.0;
+
+    // Asymmetrie der Laufzeit ist nicht messbar: halbe Laufzeit ist die Grenze
+    m.baseErrorUs = minDelay / 2 + (int64_t)llround(rms);
+    return true;
+}
+
+int64_t clockOffsetAt(const ClockModel &m, int64_t localUs)
+{
+    if (!m.valid)
+        return 0;
+    return m.offsetUs + (int64_t)llround(m.skewPpm * 1e-6 * (double)(localUs - m.refLocalUs));
+}
+
+int64_t clockToReference(const ClockModel &m, int64_t localUs)
+{
+    return localUs + clockOffsetAt(m, localUs);
+}
+
+int64_t clockErrorAt(const ClockModel &m, int64_t localUs)
+{
+    if (!m.valid)
+        return -1;
+    double age = fabs((double)(localUs - m.refLocalUs));
+    return m.baseErrorUs + (int64_t)llround(m.skewErrorPpm * 1e-6 * age);
+}
+
+int64_t clockFromReference(const ClockModel &m, int64_t referenceUs)
+{
+    // Offset hängt nur schwach (Drift) von der Zeit ab: zwei Schritte genügen
+    int64_t localUs = referenceUs - clockOffsetAt(m, referenceUs);
+    return referenceUs - clockOffsetAt(m, localUs);
+}
+
+ClockModel chainClockModel(const ClockModel &inner, const ClockModel &viaLocal)
+{
+    ClockModel out;
+    resetClockModel(out);
+    if (!inner.valid || !viaLocal.valid)
+        return out;
+
+    int64_t refA = clockToReference(inner, inner.refLocalUs);
+    int64_t refLocal = clockFromReference(viaLocal, refA);
+
+    out.valid = true;
+    out.refLocalUs = inner.refLocalUs;
+    out.offsetUs = refLocal - inner.refLocalUs;
+    out.skewPpm = inner.skewPpm - viaLocal.skewPpm; // Erste Ordnung, Drift im ppm-Bereich
+    out.skewValid = inner.skewValid && viaLocal.skewValid;
+    out.skewErrorPpm = inner.skewErrorPpm + viaLocal.skewErrorPpm;
+    out.baseErrorUs = inner.baseErrorUs + clockErrorAt(viaLocal, refLocal);
+    out.bursts = inner.bursts;
+    return out;
+}
@@ -0,0 +1,75 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+
+// Plattformunabhängig (kein Arduino.h): Uhrenmodell einer Gegenstelle
+// nach dem NTP-Verfahren mit vier Zeitstempeln pro Austausch
+//   t1 = lokales Senden, t2 = Empfang bei der Referenz,
+//   t3 = Senden der Referenz, t4 = lokaler Empfang
+// Offset = ((t2 - t1) + (t3 - t4)) / 2, Laufzeit = (t4 - t1) - (t3 - t2)
+
+#ifndef CLOCK_BURST_SIZE
+#define CLOCK_BURST_SIZE 8 // Austausche pro Burst, der mit der kleinsten Laufzeit zählt
+#endif
+#define CLOCK_HISTORY 8            // Beste Samples der letzten Bursts für die Drift-Schätzung
+#define CLOCK_MIN_SKEW_SPAN_US 20000000LL // Ab 20 s Abstand wird die Drift geschätzt
+#define CLOCK_MAX_SKEW_PPM 200.0   // Plausibilitätsgrenze für Quarz-Drift
+#define CLOCK_DEFAULT_DRIFT_PPM 50.0 // Unsicherheit solange keine Drift geschätzt ist
+
+struct ClockSample
+{
+    int64_t localUs;  // Lokale Mitte des Austauschs ((t1 + t4) / 2)
+    int64_t offsetUs; // Referenz - lokal
+    int64_t delayUs;  // Reine Funklaufzeit (Hin + Rück)
+};
+
+// Sammelt einen Burst, behält nur den Austausch mit der kleinsten Laufzeit
+struct ClockBurst
+{
+    ClockSample best;
+    uint8_t received;
+    uint32_t sequence; // Kennung des laufenden Bursts
+};
+
+struct ClockModel
+{
+    bool valid;
+    int64_t refLocalUs; // Lokaler Bezugspunkt des Modells
+    int64_t offsetUs;   // Offset am Bezugspunkt
+    double skewPpm;     // Gangabweichung der Referenz gegenüber lokal
+    bool skewValid;
+    double skewErrorPpm;   // Unsicherheit der Drift-Schätzung
+    int64_t baseErrorUs;   // Fehlergrenze am Bezugspunkt (halbe Laufzeit + Streuung)
+    uint32_t bursts;
+    ClockSample history[CLOCK_HISTORY];
+    uint8_t historyCount;
+    uint8_t historyHead;
+};
+
+void resetClockModel(ClockModel &m);
+void startClockBurst(ClockBurst &b, uint32_t sequence);
+
+// Ein Austausch mit vier Zeitstempeln; false bei unplausiblen Werten
+bool addClockExchange(ClockBurst &b, int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+// Übernimmt das beste Sample des Bursts und passt Offset + Drift neu an
+bool finishClockBurst(ClockModel &m, const ClockBurst &b);
+
+// Offset (Referenz - lokal) zum lokalen Zeitpunkt localUs, inklusive Drift
+int64_t clockOffsetAt(const ClockModel &m, int64_t localUs);
+
+// Lokale Zeit in Referenzzeit umrechnen
+int64_t clockToReference(const ClockModel &m, int64_t localUs);
+
+// Geschätzte Fehlergrenze der Umrechnung zum Zeitpunkt localUs
+int64_t clockErrorAt(const ClockModel &m, int64_t localUs);
+
+// Referenzzeit in lokale Zeit umrechnen (Umkehrung von clockToReference)
+int64_t clockFromReference(const ClockModel &m, int64_t referenceUs);
+
+// Verkettung: inner bildet Gerät -> A ab, viaLocal bildet lokal -> A ab.
+// Ergebnis bildet Gerät -> lokal ab; Fehlergrenzen und Drift-Unsicherheiten addieren sich.
+ClockModel chainClockModel(const ClockModel &inner, const ClockModel &viaLocal);
+
+#endif
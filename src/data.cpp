@@ -3,14 +3,67 @@
 Role currentRole;
 MasterStatus masterStatus = MASTER_UNKNOWN;
 uint8_t masterMac[6] = {0};
-unsigned long lastMasterSeen = 0;
-unsigned long heartbeatInterval = 5000; // 5 Sekunden
 unsigned long lastHeartbeat = 0;
 unsigned long syncSequenceNumber = 0;
 
 std::vector<DeviceInfo> discoveredDevices;
 std::vector<DeviceInfo> savedDevices;
-std::deque<RaceEntry> raceQueue;
+RaceQueue raceQueue;
+
+// Replikation der Race-Liste (Master: eigener Stand, Slave: Stand der Kopie)
+static uint32_t raceStateVersion = 0;
+static uint16_t nextRaceId = 0;
+static uint8_t replicaMasterMac[6] = {0}; // Master, von dem die Kopie stammt
+static bool replicaValid = false;
+static unsigned long lastSnapshotRequestMs = 0;
+static RaceQueue snapshotStaging; // Teile eines laufenden Snapshots
+static uint16_t snapshotOverflow = 0; // Über der Kapazität empfangene Rennen
+static uint32_t snapshotVersion = 0;
+static bool snapshotActive = false;
+static void requestRaceSnapshot();
+
+// Leader-Lease (Master: eigene Lease und Standby, Slave: Lease des Masters)
+static uint32_t currentTerm = 0;
+static unsigned long leaseSeenMs = 0; // Letzte Lease des Masters (millis())
+static uint16_t leaseDurationMs = LEASE_DURATION_MS;
+static uint8_t standbyMac[6] = {0};
+static bool hasStandby = false;
+static unsigned long lastLeaseSentMs = 0;
+static unsigned long standbyAckMs = 0; // Master: letztes Lebenszeichen des Standbys
+static uint32_t standbyVersion = 0;
+static unsigned long lastStandbyAckSentMs = 0;
+static uint32_t failoverCount = 0;
+static uint32_t splitBrainCount = 0;
+static uint32_t standbyChangeCount = 0;
+static void becomeMaster(const char *reason);
+
+// Als Master verarbeitete Events dieses terms (Ring, ältestes zuerst). Tritt dieses Gerät
+// nach einem Split-Brain zurück, gehen sie an den Gewinner, dessen Snapshot sie nicht kennt.
+struct TermEvent
+{
+    Role role;
+    uint8_t device[6];
+    uint32_t bootId;
+    uint16_t eventSeq; // 0 = selbst ausgelöst
+    int64_t time;      // Master-Zeit (µs)
+    int64_t errorUs;   // Fehlergrenze der Umrechnung, -1 = unbekannt
+    uint8_t channel;
+    uint32_t sensorErrorUs;
+    uint32_t version; // raceStateVersion vor dem Event: Kopien ab version + 1 enthalten es
+};
+static TermEvent termEvents[TERM_EVENT_LOG_SIZE];
+static uint16_t termEventHead = 0;
+static uint16_t termEventCount = 0;
+static uint32_t termEventOverflow = 0;
+static bool handoverPending = false; // Zurückgetreten, termEvents warten auf die Uhr zum neuen Master
+static unsigned long handoverSinceMs = 0;
+static uint32_t handedOverCount = 0;
+static uint32_t lostOnStepDownCount = 0;
+static void markDevice(const uint8_t *mac, bool online);
+
+// Gleitender Mittelwert der Renndauern, Grundlage für den erwarteten Zieleinlauf
+static int64_t typicalRaceUs = 0;
+static void recordRaceDuration(int64_t durationUs);
 
 Preferences preferences;
 
@@ -20,6 +73,8 @@ static bool roleLoaded = false;
 static float cachedMinDistanceCache = 2.0f;
 static float cachedMaxDistanceCache = 100.0f;
 static bool distanceCacheLoaded = false;
+static uint16_t cachedClusterId = DEFAULT_CLUSTER_ID;
+static bool clusterIdLoaded = false;
 
 // Cache-Invalidierung für Distanzen
 void invalidateDistanceCache()
@@ -77,7 +132,7 @@ void loadDeviceListFromPreferences()
             info.lastSeen = 0;
             savedDevices.push_back(info);
 
-            addDeviceToPeer(info.mac);
+            addDeviceToPeer(info.mac, true); // Gespeicherte Geräte bleiben in der Peer-Tabelle
         }
     }
     else
@@ -105,6 +160,21 @@ void writeDeviceListToPreferences()
     preferences.end();
 }
 
+size_t loadEventJournal(void *buffer, size_t maxLen)
+{
+    preferences.begin("lichtschranke", true);
+    size_t len = preferences.isKey("journal") ? preferences.getBytes("journal", buffer, maxLen) : 0;
+    preferences.end();
+    return len;
+}
+
+void saveEventJournal(const void *buffer, size_t len)
+{
+    preferences.begin("lichtschranke", false);
+    preferences.putBytes("journal", buffer, len);
+    preferences.end();
+}
+
 void resetAll()
 {
     Serial.println("[CRITICAL] Lösche alle Einstellungen.");
@@ -197,7 +267,7 @@ void addSavedDevice(const uint8_t *mac, Role role)
     {
         savedDevices.push_back(makeDeviceInfo(mac, role, false, 0));
     }
-    addDeviceToPeer(mac);
+    addDeviceToPeer(mac, true);
     writeDeviceListToPreferences();
     printDeviceLists();
 
@@ -277,25 +347,31 @@ void clearDiscoveredDevices()
 #define DEFAULT_MAX_DISTANCE_CM 100
 #endif
 
-int getMinDistance()
+// Kanal 0 behält die bisherigen Schlüssel, weitere Kanäle bekommen eine Ziffer
+static String distanceKey(const char *base, uint8_t channel)
+{
+    return channel == 0 ? String(base) : String(base) + String(channel);
+}
+
+int getMinDistance(uint8_t channel)
 {
     preferences.begin("lichtschranke", true);
-    int minDistance = preferences.getInt("minDistance", DEFAULT_MIN_DISTANCE_CM);
+    int minDistance = preferences.getInt(distanceKey("minDistance", channel).c_str(), DEFAULT_MIN_DISTANCE_CM);
     preferences.end();
-    Serial.printf("[DISTANCE_DEBUG] Min-Distanz geladen: %d cm\n", minDistance);
+    Serial.printf("[DISTANCE_DEBUG] Min-Distanz Kanal %d geladen: %d cm\n", channel, minDistance);
     return minDistance;
 }
 
-int getMaxDistance()
+int getMaxDistance(uint8_t channel)
 {
     preferences.begin("lichtschranke", true);
-    int maxDistance = preferences.getInt("maxDistance", DEFAULT_MAX_DISTANCE_CM);
+    int maxDistance = preferences.getInt(distanceKey("maxDistance", channel).c_str(), DEFAULT_MAX_DISTANCE_CM);
     preferences.end();
-    Serial.printf("[DISTANCE_DEBUG] Max-Distanz geladen: %d cm\n", maxDistance);
+    Serial.printf("[DISTANCE_DEBUG] Max-Distanz Kanal %d geladen: %d cm\n", channel, maxDistance);
     return maxDistance;
 }
 
-void setMinDistance(int minDistance)
+void setMinDistance(int minDistance, uint8_t channel)
 {
     if (minDistance < 2 || minDistance > 200)
     {
@@ -304,16 +380,16 @@ void setMinDistance(int minDistance)
     }
 
     preferences.begin("lichtschranke", false);
-    preferences.putInt("minDistance", minDistance);
+    preferences.putInt(distanceKey("minDistance", channel).c_str(), minDistance);
     preferences.end();
 
-    Serial.printf("[DISTANCE_DEBUG] Min-Distanz gesetzt auf: %d cm\n", minDistance);
+    Serial.printf("[DISTANCE_DEBUG] Min-Distanz Kanal %d gesetzt auf: %d cm\n", channel, minDistance);
 
     // Sensor-Cache aktualisieren
     updateDistanceCache();
 }
 
-void setMaxDistance(int maxDistance)
+void setMaxDistance(int maxDistance, uint8_t channel)
 {
     if (maxDistance < 2 || maxDistance > 200)
     {
@@ -322,15 +398,134 @@ void setMaxDistance(int maxDistance)
     }
 
     preferences.begin("lichtschranke", false);
-    preferences.putInt("maxDistance", maxDistance);
+    preferences.putInt(distanceKey("maxDistance", channel).c_str(), maxDistance);
     preferences.end();
 
-    Serial.printf("[DISTANCE_DEBUG] Max-Distanz gesetzt auf: %d cm\n", maxDistance);
+    Serial.printf("[DISTANCE_DEBUG] Max-Distanz Kanal %d gesetzt auf: %d cm\n", channel, maxDistance);
 
     // Sensor-Cache aktualisieren
     updateDistanceCache();
 }
 
+// Hintergrund der leeren Bahn aus der Kalibrierung (0 = nie kalibriert)
+float getBaseline(uint8_t channel)
+{
+    preferences.begin("lichtschranke", true);
+    float background = preferences.getFloat(distanceKey("baseline", channel).c_str(), 0.0f);
+    preferences.end();
+    return background;
+}
+
+void setBaseline(float backgroundCm, float noiseCm, uint8_t channel)
+{
+    preferences.begin("lichtschranke", false);
+    preferences.putFloat(distanceKey("baseline", channel).c_str(), backgroundCm);
+    preferences.putFloat(distanceKey("baseNoise", channel).c_str(), noiseCm);
+    preferences.end();
+
+    Serial.printf("[DISTANCE_DEBUG] Hintergrund Kanal %d gespeichert: %.1f cm (Rauschen %.1f cm)\n", channel, backgroundCm, noiseCm);
+}
+
+float getBaselineNoise(uint8_t channel)
+{
+    preferences.begin("lichtschranke", true);
+    float noise = preferences.getFloat(distanceKey("baseNoise", channel).c_str(), 0.0f);
+    preferences.end();
+    return noise;
+}
+
+// Abtastperioden des Sensor-Tasks je Status
+static const char *periodKeys[STATUS_COUNT] = {"periodNormal", "periodTrig", "periodCool", "periodTrigCool"};
+
+SensorPeriods getSensorPeriods()
+{
+    SensorPeriods periods = {{SENSOR_PERIOD_NORMAL_MS, SENSOR_PERIOD_TRIGGERED_MS,
+                              SENSOR_PERIOD_COOLDOWN_MS, SENSOR_PERIOD_TRIGGERED_IN_COOLDOWN_MS}};
+    preferences.begin("lichtschranke", true);
+    for (int i = 0; i < STATUS_COUNT; i++)
+    {
+        periods.periodMs[i] = preferences.getUInt(periodKeys[i], periods.periodMs[i]);
+    }
+    preferences.end();
+    return periods;
+}
+
+void setSensorPeriods(SensorPeriods periods)
+{
+    preferences.begin("lichtschranke", false);
+    for (int i = 0; i < STATUS_COUNT; i++)
+    {
+        if (periods.periodMs[i] < 1 || periods.periodMs[i] > 1000)
+        {
+            Serial.printf("[SENSOR_DEBUG] Ungültige Periode %d ms für Status %d, verwende 10 ms\n", periods.periodMs[i], i);
+            periods.periodMs[i] = 10;
+        }
+        preferences.putUInt(periodKeys[i], periods.periodMs[i]);
+    }
+    preferences.end();
+
+    // Sensor-Task-Cache aktualisieren und Statistik neu beginnen
+    updateSensorPeriodCache();
+    resetSensorTimingStats();
+}
+
+// Trigger-Filter Einstellungen
+FilterConfig getFilterConfig()
+{
+    FilterConfig cfg = defaultFilterConfig();
+    preferences.begin("lichtschranke", true);
+    cfg.mode = static_cast<FilterMode>(preferences.getUInt("filterMode", cfg.mode));
+    cfg.window = preferences.getUInt("filterWindow", cfg.window);
+    cfg.hampelK = preferences.getFloat("hampelK", cfg.hampelK);
+    cfg.hysteresisCm = preferences.getFloat("hysteresisCm", cfg.hysteresisCm);
+    cfg.confirmSamples = preferences.getUInt("confirmN", cfg.confirmSamples);
+    preferences.end();
+    sanitizeFilterConfig(cfg);
+    return cfg;
+}
+
+void setFilterConfig(FilterConfig cfg)
+{
+    sanitizeFilterConfig(cfg);
+
+    preferences.begin("lichtschranke", false);
+    preferences.putUInt("filterMode", static_cast<int>(cfg.mode));
+    preferences.putUInt("filterWindow", cfg.window);
+    preferences.putFloat("hampelK", cfg.hampelK);
+    preferences.putFloat("hysteresisCm", cfg.hysteresisCm);
+    preferences.putUInt("confirmN", cfg.confirmSamples);
+    preferences.end();
+
+    Serial.printf("[FILTER_DEBUG] Filter gesetzt auf: %s, Fenster %d\n", filterModeToString(cfg.mode), cfg.window);
+
+    // Sensor-Cache aktualisieren
+    updateFilterCache();
+}
+
+// Cluster-ID: wird bei jedem gesendeten und empfangenen Frame gebraucht, daher gecacht
+uint16_t getClusterId()
+{
+    if (clusterIdLoaded)
+        return cachedClusterId;
+
+    preferences.begin("lichtschranke", true);
+    cachedClusterId = preferences.getUShort("clusterId", DEFAULT_CLUSTER_ID);
+    preferences.end();
+    clusterIdLoaded = true;
+    return cachedClusterId;
+}
+
+void setClusterId(uint16_t clusterId)
+{
+    preferences.begin("lichtschranke", false);
+    preferences.putUShort("clusterId", clusterId);
+    preferences.end();
+    cachedClusterId = clusterId;
+    clusterIdLoaded = true;
+
+    Serial.printf("[ESP_NOW_DEBUG] Cluster-ID gesetzt auf: %u\n", clusterId);
+}
+
 // Brightness Settings Funktionen
 #ifndef DEFAULT_BRIGHTNESS
 #define DEFAULT_BRIGHTNESS 1
@@ -373,68 +568,72 @@ void setBrightness(int brightness)
     }
 }
 
-void addRaceStart(unsigned long startTime)
+void addRaceStart(int64_t startTime)
 {
     if (isMaster())
     {
-        masterAddRaceStart(startTime, getMacAddress(), millis());
+        masterAddRaceStart(startTime, getMacAddress(), getTimeUs());
     }
     else
     {
-        slaveHandleRaceStart(startTime, getMacAddress(), millis());
+        slaveHandleRaceStart(startTime, getMacAddress(), getTimeUs());
     }
 }
 
-bool finishRace(unsigned long finishTime, unsigned long &startTime, unsigned long &duration)
+bool finishRace(int64_t finishTime, int64_t &startTime, int64_t &duration)
 {
     if (isMaster())
     {
-        masterFinishRace(finishTime, getMacAddress(), millis());
-
-        // Gebe die Daten des letzten beendeten Rennens zurück
-        for (auto it = raceQueue.rbegin(); it != raceQueue.rend(); ++it)
-        {
-            if (it->isFinished)
-            {
-                startTime = it->startTime;
-                duration = it->duration;
-                return true;
-            }
-        }
-        return false;
+        masterFinishRace(finishTime, getMacAddress(), getTimeUs());
     }
     else
     {
-        slaveHandleRaceFinish(finishTime, getMacAddress(), millis());
-
-        // Bei Slaves: Warte auf Update vom Master
-        // Diese Funktion wird hauptsächlich für Kompatibilität beibehalten
-        if (raceQueue.empty())
-            return false;
+        // Bei Slaves: Warte auf Update vom Master, bis dahin gelten die Daten der Kopie
+        slaveHandleRaceFinish(finishTime, getMacAddress(), getTimeUs());
+    }
 
-        // Verwende die Daten vom Master
-        for (auto it = raceQueue.rbegin(); it != raceQueue.rend(); ++it)
-        {
-            if (it->isFinished)
-            {
-                startTime = it->startTime;
-                duration = it->duration;
-                return true;
-            }
-        }
+    // Gebe die Daten des letzten beendeten Rennens zurück
+    const RaceEntry *last = raceQueue.lastFinished();
+    if (last == nullptr)
         return false;
-    }
+    startTime = last->startTime;
+    duration = last->duration;
+    return true;
 }
 
 int getLaufCount()
 {
-    int runningRaces = 0;
-    for (const auto &race : raceQueue)
+    return raceQueue.runningCount();
+}
+
+static void recordRaceDuration(int64_t durationUs)
+{
+    if (durationUs <= 0)
+        return;
+    typicalRaceUs = typicalRaceUs == 0 ? durationUs : (typicalRaceUs * 3 + durationUs) / 4;
+}
+
+bool getNextExpectedFinishUs(int64_t &remainingUs, int64_t overdueLimitUs)
+{
+    if (typicalRaceUs == 0)
+        return false;
+
+    // Race-Liste liegt in Master-Zeit, auch die Kopie auf den Slaves
+    int64_t now = localToMasterTime(getTimeUs());
+    bool found = false;
+    for (uint16_t i = 0; i < raceQueue.size(); i++)
     {
-        if (!race.isFinished)
-            runningRaces++;
+        const RaceEntry &race = raceQueue[i];
+        if (race.isFinished)
+            continue;
+        int64_t remaining = race.startTime + typicalRaceUs - now;
+        if (remaining < -overdueLimitUs)
+            continue; // Deutlich überfällig, zählt nicht mehr als erwartet
+        if (!found || remaining < remainingUs)
+            remainingUs = remaining;
+        found = true;
     }
-    return runningRaces;
+    return found;
 }
 
 // Master-System Funktionen
@@ -478,6 +677,19 @@ void determineMaster()
 {
     Serial.println("[MASTER_DEBUG] Bestimme Master-Gerät...");
 
+    // Mit gültiger Lease gibt es nichts zu wählen: der Inhaber bleibt Master
+    if (isMaster())
+    {
+        Serial.printf("[MASTER_DEBUG] Dieses Gerät bleibt Master (term %lu)\n", (unsigned long)currentTerm);
+        return;
+    }
+    if (isSlave() && millis() - leaseSeenMs <= LEASE_ORPHAN_MS)
+    {
+        Serial.printf("[MASTER_DEBUG] Lease von %s gültig (term %lu), keine Wahl\n",
+                      macToString(masterMac).c_str(), (unsigned long)currentTerm);
+        return;
+    }
+
     // Debug: Aktuelle MAC-Adresse ausgeben
     Serial.printf("[MASTER_DEBUG] Eigene MAC-Adresse: %s\n", macToString(getMacAddress()).c_str());
 
@@ -525,151 +737,352 @@ void determineMaster()
     if (!foundLower)
     {
         // Dieses Gerät hat die niedrigste MAC
-        if (!isMaster())
-        {
-            Serial.printf("[MASTER_DEBUG] Dieses Gerät wird Master (niedrigste MAC): %s\n", macToString(getMacAddress()).c_str());
-            setMasterStatus(MASTER_MASTER);
-            memcpy(masterMac, getMacAddress(), 6);
-        }
-        else
-        {
-            Serial.printf("[MASTER_DEBUG] Dieses Gerät bleibt Master: %s\n", macToString(getMacAddress()).c_str());
-        }
+        becomeMaster("niedrigste MAC");
     }
     else
     {
-        // Ein anderes Gerät ist Master
-        if (!isSlave() || memcmp(masterMac, lowestMac, 6) != 0)
-        {
-            Serial.printf("[MASTER_DEBUG] Anderes Gerät wird Master: %s (aktueller Status: %s)\n",
-                          macToString(lowestMac).c_str(), isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
-            setMasterStatus(MASTER_SLAVE);
-            memcpy(masterMac, lowestMac, 6);
-        }
-        else
-        {
-            Serial.printf("[MASTER_DEBUG] Anderes Gerät bleibt Master: %s\n", macToString(lowestMac).c_str());
-        }
+        // Ein anderes Gerät soll Master werden; bis zu seiner ersten Lease gilt eine Schonfrist
+        Serial.printf("[MASTER_DEBUG] Anderes Gerät wird Master: %s (aktueller Status: %s)\n",
+                      macToString(lowestMac).c_str(), isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
+        memcpy(masterMac, lowestMac, 6);
+        setMasterStatus(MASTER_SLAVE);
+        leaseSeenMs = millis();
     }
 
-    lastMasterSeen = millis();
     Serial.printf("[MASTER_DEBUG] Master-Bestimmung abgeschlossen. Master: %s, Eigener Status: %s\n",
                   macToString(masterMac).c_str(), isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
 }
 
-void syncTimeWithMaster()
+// Uhrenmodelle der Gegenstellen (clockSync), befüllt ausschließlich durch Sync-Bursts
+struct PeerClock
 {
-    if (isMaster())
-        return;
+    bool used;
+    uint8_t mac[6];
+    ClockModel model;
+    ClockBurst burst;
+};
 
-    sendTimeSyncRequest();
+static PeerClock peerClocks[CLOCK_PEERS_MAX];
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Aufruf nur innerhalb von clockMux
+static PeerClock *findPeerClock(const uint8_t *mac, bool create)
+{
+    PeerClock *freeSlot = nullptr;
+    for (auto &pc : peerClocks)
+    {
+        if (pc.used && memcmp(pc.mac, mac, 6) == 0)
+            return &pc;
+        if (!pc.used && freeSlot == nullptr)
+            freeSlot = &pc;
+    }
+    if (!create || freeSlot == nullptr)
+        return nullptr;
+
+    freeSlot->used = true;
+    memcpy(freeSlot->mac, mac, 6);
+    resetClockModel(freeSlot->model);
+    startClockBurst(freeSlot->burst, 0);
+    return freeSlot;
 }
 
-void handleMasterHeartbeat(const uint8_t *incomingMasterMac, unsigned long masterTime)
+bool getPeerClock(const uint8_t *mac, ClockModel &model)
 {
-    Serial.printf("[MASTER_DEBUG] Heartbeat empfangen von: %s (aktueller Master: %s)\n",
-                  macToString(incomingMasterMac).c_str(), macToString(masterMac).c_str());
+    portENTER_CRITICAL(&clockMux);
+    PeerClock *pc = findPeerClock(mac, false);
+    bool found = pc != nullptr && pc->model.valid;
+    if (found)
+        model = pc->model;
+    portEXIT_CRITICAL(&clockMux);
+    return found;
+}
 
-    if (memcmp(masterMac, incomingMasterMac, 6) == 0)
+int getPeerClocks(uint8_t macs[][6], ClockModel *models, int maxCount)
+{
+    int count = 0;
+    portENTER_CRITICAL(&clockMux);
+    for (const auto &pc : peerClocks)
     {
-        lastMasterSeen = millis();
-        Serial.printf("[MASTER_DEBUG] Heartbeat vom bekannten Master empfangen: %s\n", macToString(incomingMasterMac).c_str());
+        if (!pc.used || !pc.model.valid || count >= maxCount)
+            continue;
+        memcpy(macs[count], pc.mac, 6);
+        models[count] = pc.model;
+        count++;
     }
-    else
-    {
-        Serial.printf("[MASTER_DEBUG] Heartbeat von anderem Master. Vergleiche MACs:\n");
-        Serial.printf("[MASTER_DEBUG] Incoming Master: %s\n", macToString(incomingMasterMac).c_str());
-        Serial.printf("[MASTER_DEBUG] Eigene MAC: %s\n", macToString(getMacAddress()).c_str());
+    portEXIT_CRITICAL(&clockMux);
+    return count;
+}
+
+// Master: Uhrenmodelle der Slaves (Master - Slave), gemeldet nach deren Sync-Bursts
+struct DeviceClock
+{
+    bool used;
+    uint8_t mac[6];
+    ClockModel model;
+    int64_t updatedUs; // Empfang der letzten Meldung (Master-Zeit)
+};
+
+static DeviceClock deviceClocks[CLOCK_PEERS_MAX];
+
+void handleClockReport(const uint8_t *deviceMac, const ClockModel &model)
+{
+    // Der Standby sammelt mit, damit er nach einer Übernahme sofort umrechnen kann
+    if (!isMaster() && !isStandby())
+        return;
 
-        // Prüfe, ob der sendende Master eine niedrigere MAC-Adresse hat
-        if (memcmp(incomingMasterMac, getMacAddress(), 6) < 0)
+    portENTER_CRITICAL(&clockMux);
+    DeviceClock *slot = nullptr;
+    DeviceClock *oldest = nullptr;
+    for (auto &dc : deviceClocks)
+    {
+        if (dc.used && memcmp(dc.mac, deviceMac, 6) == 0)
         {
-            // Der andere Master hat eine niedrigere MAC - er sollte Master sein
-            Serial.printf("[MASTER_DEBUG] Heartbeat von berechtigtem Master empfangen: %s (niedrigere MAC)\n", macToString(incomingMasterMac).c_str());
-            setMasterStatus(MASTER_SLAVE);
-            memcpy(masterMac, incomingMasterMac, 6);
-            lastMasterSeen = millis();
+            slot = &dc;
+            break;
         }
-        else
+        if (!dc.used && slot == nullptr)
+            slot = &dc;
+        if (dc.used && (oldest == nullptr || dc.updatedUs < oldest->updatedUs))
+            oldest = &dc;
+    }
+    if (slot == nullptr)
+        slot = oldest; // Tabelle voll: am längsten stumme Gegenstelle ersetzen
+    slot->used = true;
+    memcpy(slot->mac, deviceMac, 6);
+    slot->model = model;
+    slot->updatedUs = getTimeUs();
+    portEXIT_CRITICAL(&clockMux);
+
+    markDevice(deviceMac, true);
+    updateTimeOffset(deviceMac, model.offsetUs);
+    Serial.printf("[SYNC_DEBUG] Uhrenmodell von %s: Offset %lld us, Drift %.2f ppm, Fehler ±%lld us\n",
+                  macToString(deviceMac).c_str(), (long long)model.offsetUs, model.skewPpm, (long long)model.baseErrorUs);
+}
+
+bool getDeviceClock(const uint8_t *deviceMac, ClockModel &model, int64_t &updatedUs)
+{
+    bool found = false;
+    portENTER_CRITICAL(&clockMux);
+    for (const auto &dc : deviceClocks)
+    {
+        if (dc.used && memcmp(dc.mac, deviceMac, 6) == 0)
         {
-            // Der andere Master hat eine höhere MAC - wir sollten Master sein
-            Serial.printf("[MASTER_DEBUG] Heartbeat von unberechtigtem Master empfangen: %s (höhere MAC)\n", macToString(incomingMasterMac).c_str());
-            if (!isMaster())
-            {
-                Serial.printf("[MASTER_DEBUG] Führe Master-Bestimmung durch, da wir nicht Master sind\n");
-                determineMaster();
-            }
-            else
-            {
-                Serial.printf("[MASTER_DEBUG] Ignoriere Heartbeat, da wir bereits Master sind\n");
-            }
+            model = dc.model;
+            updatedUs = dc.updatedUs;
+            found = true;
+            break;
         }
     }
+    portEXIT_CRITICAL(&clockMux);
+    return found;
 }
 
-void sendHeartbeat()
+int getDeviceClocks(uint8_t macs[][6], ClockModel *models, int64_t *updatedUs, int maxCount)
 {
-    if (isMaster())
+    int count = 0;
+    portENTER_CRITICAL(&clockMux);
+    for (const auto &dc : deviceClocks)
     {
-        sendMasterHeartbeat();
-        lastHeartbeat = millis();
+        if (!dc.used || count >= maxCount)
+            continue;
+        memcpy(macs[count], dc.mac, 6);
+        models[count] = dc.model;
+        updatedUs[count] = dc.updatedUs;
+        count++;
     }
+    portEXIT_CRITICAL(&clockMux);
+    return count;
 }
 
-void checkMasterOnline()
+bool deviceToMasterTime(const uint8_t *deviceMac, int64_t deviceUs, int64_t &masterUs, int64_t &errorUs)
 {
-    if (isSlave() && (millis() - lastMasterSeen > heartbeatInterval * 3))
+    if (memcmp(deviceMac, getMacAddress(), 6) == 0)
     {
-        Serial.println("[MASTER_DEBUG] Master ist offline, bestimme neuen Master");
-        // Master als offline markieren
-        for (auto &dev : savedDevices)
-        {
-            if (memcmp(dev.mac, masterMac, 6) == 0)
-            {
-                dev.isOnline = false;
-                break;
-            }
-        }
-        determineMaster();
+        masterUs = deviceUs;
+        errorUs = 0;
+        return true;
+    }
+
+    ClockModel model;
+    int64_t updatedUs;
+    if (!getDeviceClock(deviceMac, model, updatedUs))
+        return false;
+    masterUs = clockToReference(model, deviceUs);
+    errorUs = clockErrorAt(model, deviceUs);
+    return true;
+}
+
+// Event-Zeit eines Geräts in Master-Zeit. Vorrang hat das gemeldete Uhrenmodell,
+// danach die Übersetzung des Senders beim Auslösen (nachgelieferte Events), zuletzt
+// die Ankunftszeit abzüglich der vom Sender gemessenen Verweildauer.
+// errorUs = Fehlergrenze der Umrechnung, -1 wenn unbekannt
+static int64_t eventToMasterTime(const uint8_t *deviceMac, int64_t eventTime, int64_t localTime, int64_t &errorUs, const RaceEventSource *source)
+{
+    int64_t masterUs;
+    // Nach einem Neustart des Senders beschreibt sein Uhrenmodell eine andere Zeitbasis
+    bool previousBoot = source != nullptr && source->previousBoot;
+    if (!previousBoot && deviceToMasterTime(deviceMac, eventTime, masterUs, errorUs))
+    {
+        Serial.printf("[MASTER_DEBUG] Zeit von %s: %lld us -> Master %lld us (±%lld us)\n",
+                      macToString(deviceMac).c_str(), (long long)eventTime, (long long)masterUs, (long long)errorUs);
+        return masterUs;
+    }
+
+    if (source != nullptr && source->hasTranslation)
+    {
+        errorUs = source->masterErrorUs;
+        Serial.printf("[MASTER_DEBUG] Zeit von %s aus Übersetzung des Senders: %lld us (±%lld us)\n",
+                      macToString(deviceMac).c_str(), (long long)source->masterTime, (long long)errorUs);
+        return source->masterTime;
     }
+
+    errorUs = -1;
+    masterUs = getTimeUs() - (localTime - eventTime);
+    Serial.printf("[MASTER_DEBUG] WARNUNG: Kein Uhrenmodell für %s, verwende Ankunftszeit %lld us\n",
+                  macToString(deviceMac).c_str(), (long long)masterUs);
+    return masterUs;
 }
 
-// Zeit-Synchronisation
-void requestTimeSync()
+int64_t localToMasterTime(int64_t localUs)
 {
-    if (isSlave())
+    ClockModel model;
+    if (isMaster() || !getPeerClock(getMasterMac(), model))
+        return localUs;
+    return clockToReference(model, localUs);
+}
+
+unsigned long getClockSyncIntervalMs()
+{
+    ClockModel model;
+    // Bis die Drift geschätzt ist, häufiger synchronisieren
+    if (!getPeerClock(getMasterMac(), model) || !model.skewValid)
+        return CLOCK_SYNC_FAST_INTERVAL_MS;
+    return CLOCK_SYNC_INTERVAL_MS;
+}
+
+// Burst aus CLOCK_BURST_SIZE Austauschen, danach Offset + Drift neu anpassen.
+// Blockiert den Aufrufer (Master-Task) für wenige 100 ms.
+void syncTimeWithMaster()
+{
+    if (!isSlave())
+        return;
+
+    uint8_t target[6];
+    memcpy(target, getMasterMac(), 6);
+    unsigned long sequence = ++syncSequenceNumber;
+
+    portENTER_CRITICAL(&clockMux);
+    PeerClock *pc = findPeerClock(target, true);
+    if (pc != nullptr)
+        startClockBurst(pc->burst, sequence);
+    portEXIT_CRITICAL(&clockMux);
+    if (pc == nullptr)
+    {
+        Serial.println("[SYNC_DEBUG] Keine freie Uhren-Tabelle für den Master");
+        return;
+    }
+
+    for (int i = 0; i < CLOCK_BURST_SIZE; i++)
+    {
+        sendTimeSyncRequest(sequence);
+        vTaskDelay(pdMS_TO_TICKS(CLOCK_BURST_SPACING_MS));
+    }
+    vTaskDelay(pdMS_TO_TICKS(CLOCK_BURST_TIMEOUT_MS)); // Letzte Antworten abwarten
+
+    portENTER_CRITICAL(&clockMux);
+    pc = findPeerClock(target, false);
+    bool ok = pc != nullptr && pc->burst.sequence == sequence && finishClockBurst(pc->model, pc->burst);
+    ClockModel model;
+    uint8_t received = 0;
+    if (pc != nullptr)
+    {
+        model = pc->model;
+        received = pc->burst.received;
+        pc->burst.sequence = 0; // Späte Antworten verwerfen
+    }
+    portEXIT_CRITICAL(&clockMux);
+
+    if (!ok)
+    {
+        Serial.printf("[SYNC_DEBUG] Zeit-Sync-Burst ohne Antwort vom Master %s\n", macToString(target).c_str());
+        return;
+    }
+
+    int64_t now = getTimeUs();
+    int64_t offset = clockOffsetAt(model, now);
+    updateTimeOffset(target, offset);
+    sendClockReport(model);
+    Serial.printf("[SYNC_DEBUG] Uhrenmodell Master: Offset %lld us, Drift %.2f ppm%s, Fehler ±%lld us (%d/%d Antworten, beste Laufzeit %lld us)\n",
+                  (long long)offset, model.skewPpm, model.skewValid ? "" : " (noch nicht geschätzt)",
+                  (long long)clockErrorAt(model, now), received, CLOCK_BURST_SIZE,
+                  (long long)model.history[(model.historyHead + CLOCK_HISTORY - 1) % CLOCK_HISTORY].delayUs);
+}
+
+void handleMasterHeartbeat(const uint8_t *incomingMasterMac, int64_t masterTime, uint32_t stateVersion)
+{
+    // Wer Master ist, entscheidet die Lease; Heartbeats anderer Geräte zählen nicht
+    if (memcmp(masterMac, incomingMasterMac, 6) != 0)
+    {
+        Serial.printf("[MASTER_DEBUG] Heartbeat von %s ignoriert, Master ist %s\n",
+                      macToString(incomingMasterMac).c_str(), macToString(masterMac).c_str());
+        return;
+    }
+
+    // Verpasste Deltas oder neuer Master: Kopie der Race-Liste neu anfordern
+    if (isSlave() &&
+        (!replicaValid || memcmp(replicaMasterMac, incomingMasterMac, 6) != 0 || stateVersion != raceStateVersion))
     {
-        sendTimeSyncRequest();
+        Serial.printf("[SLAVE_DEBUG] Race-Stand %lu, Master meldet %lu: fordere Snapshot an\n",
+                      (unsigned long)raceStateVersion, (unsigned long)stateVersion);
+        requestRaceSnapshot();
     }
 }
 
-void handleTimeSyncRequest(const uint8_t *requesterMac, unsigned long requesterTime)
+void sendHeartbeat(bool bypassQuiet)
 {
     if (isMaster())
     {
-        sendTimeSyncResponse(requesterMac, requesterTime, syncSequenceNumber++);
+        sendMasterHeartbeat(bypassQuiet);
+        lastHeartbeat = millis();
     }
 }
 
-void handleTimeSyncResponse(const uint8_t *incomingMasterMac, unsigned long masterTime, unsigned long roundTripTime)
+// Zeit-Synchronisation
+void requestTimeSync()
+{
+    syncTimeWithMaster();
+}
+
+void handleTimeSyncRequest(const uint8_t *requesterMac, int64_t requesterTime, int64_t receiveTime, unsigned long sequenceNumber)
 {
-    if (isSlave() && memcmp(masterMac, incomingMasterMac, 6) == 0)
+    if (isMaster())
     {
-        long offset = masterTime - millis() + (roundTripTime / 2);
-        updateTimeOffset(incomingMasterMac, offset);
-        Serial.printf("[SYNC_DEBUG] Zeit-Offset zum Master: %ld ms\n", offset);
+        sendTimeSyncResponse(requesterMac, requesterTime, receiveTime, sequenceNumber);
     }
 }
 
-long getTimeOffset(const uint8_t *deviceMac)
+void handleTimeSyncResponse(const uint8_t *incomingMasterMac, int64_t t1, int64_t t2, int64_t t3, int64_t t4, unsigned long sequenceNumber)
+{
+    if (!isSlave() || memcmp(masterMac, incomingMasterMac, 6) != 0)
+        return;
+
+    // Nur Antworten des laufenden Bursts zählen
+    portENTER_CRITICAL(&clockMux);
+    PeerClock *pc = findPeerClock(incomingMasterMac, false);
+    if (pc != nullptr && pc->burst.sequence != 0 && pc->burst.sequence == sequenceNumber)
+        addClockExchange(pc->burst, t1, t2, t3, t4);
+    portEXIT_CRITICAL(&clockMux);
+}
+
+int64_t getTimeOffset(const uint8_t *deviceMac)
 {
     // Prüfe erst die gespeicherten Geräte
     for (const auto &dev : savedDevices)
     {
         if (memcmp(dev.mac, deviceMac, 6) == 0)
         {
-            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s aus savedDevices: %ld ms\n",
-                          macToString(deviceMac).c_str(), dev.timeOffset);
+            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s aus savedDevices: %lld us\n",
+                          macToString(deviceMac).c_str(), (long long)dev.timeOffset);
             return dev.timeOffset;
         }
     }
@@ -679,8 +1092,8 @@ long getTimeOffset(const uint8_t *deviceMac)
     {
         if (memcmp(dev.mac, deviceMac, 6) == 0)
         {
-            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s aus discoveredDevices: %ld ms\n",
-                          macToString(deviceMac).c_str(), dev.timeOffset);
+            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s aus discoveredDevices: %lld us\n",
+                          macToString(deviceMac).c_str(), (long long)dev.timeOffset);
             return dev.timeOffset;
         }
     }
@@ -690,7 +1103,7 @@ long getTimeOffset(const uint8_t *deviceMac)
     return 0;
 }
 
-void updateTimeOffset(const uint8_t *deviceMac, long offset)
+void updateTimeOffset(const uint8_t *deviceMac, int64_t offset)
 {
     bool updated = false;
 
@@ -702,8 +1115,8 @@ void updateTimeOffset(const uint8_t *deviceMac, long offset)
             dev.timeOffset = offset;
             dev.lastSeen = millis();
             updated = true;
-            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s in savedDevices aktualisiert: %ld ms\n",
-                          macToString(deviceMac).c_str(), offset);
+            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s in savedDevices aktualisiert: %lld us\n",
+                          macToString(deviceMac).c_str(), (long long)offset);
             break;
         }
     }
@@ -716,8 +1129,8 @@ void updateTimeOffset(const uint8_t *deviceMac, long offset)
             dev.timeOffset = offset;
             dev.lastSeen = millis();
             updated = true;
-            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s in discoveredDevices aktualisiert: %ld ms\n",
-                          macToString(deviceMac).c_str(), offset);
+            Serial.printf("[SYNC_DEBUG] Zeit-Offset für %s in discoveredDevices aktualisiert: %lld us\n",
+                          macToString(deviceMac).c_str(), (long long)offset);
             break;
         }
     }
@@ -729,160 +1142,575 @@ void updateTimeOffset(const uint8_t *deviceMac, long offset)
     }
 }
 
-// Race-Management (nur Master)
-void masterAddRaceStart(unsigned long startTime, const uint8_t *startDevice, unsigned long localTime)
+// Fehlergrenze aufrunden, damit sie eine Grenze bleibt
+static uint8_t encodeRaceError(int64_t errorUs)
 {
-    if (!isMaster())
-    {
-        Serial.printf("[MASTER_DEBUG] masterAddRaceStart aufgerufen, aber dieses Gerät ist nicht Master (Status: %s)\n",
-                      isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
-        return;
-    }
-
-    // Berechne Zeit-Offset zwischen Master und Start-Gerät
-    if (memcmp(startDevice, getMacAddress(), 6) != 0)
-    {
-        // Zeit-Offset: (unsere Zeit) - (lokale Zeit des anderen Geräts)
-        // Dieser Offset wird später zu der anderen Zeit addiert, um sie zu korrigieren
-        long estimatedOffset = (long)millis() - (long)startTime;
-        updateTimeOffset(startDevice, estimatedOffset);
-        Serial.printf("[MASTER_DEBUG] Zeit-Offset für Start-Gerät %s geschätzt: %ld ms\n",
-                      macToString(startDevice).c_str(), estimatedOffset);
-    }
+    if (errorUs < 0)
+        return RACE_ERROR_UNKNOWN;
+    int64_t units = (errorUs + RACE_ERROR_UNIT_US - 1) / RACE_ERROR_UNIT_US;
+    return units >= RACE_ERROR_UNKNOWN ? RACE_ERROR_UNKNOWN : (uint8_t)units;
+}
 
-    RaceEntry entry;
-    entry.startTime = startTime;
-    entry.startTimeLocal = localTime;
-    memcpy(entry.startDevice, startDevice, 6);
-    entry.isFinished = false;
-    entry.finishTime = 0;
-    entry.finishTimeLocal = 0;
-    memset(entry.finishDevice, 0, 6);
-    entry.duration = 0;
+int64_t getRaceErrorUs(const RaceEntry &race)
+{
+    if (race.errorBound == RACE_ERROR_UNKNOWN)
+        return -1;
+    return (int64_t)race.errorBound * RACE_ERROR_UNIT_US;
+}
 
-    raceQueue.push_back(entry);
+uint32_t getRaceStateVersion()
+{
+    return raceStateVersion;
+}
 
-    Serial.printf("[MASTER_DEBUG] Rennen gestartet von %s, Zeit: %lu (Queue-Größe: %d)\n",
-                  macToString(startDevice).c_str(), startTime, raceQueue.size());
+// Master: jede Änderung der Race-Liste als Delta mit neuem Stand verteilen
+static void publishRaceDelta(RaceDeltaOp op, const RaceEntry &race, const RaceEventSource *source = nullptr)
+{
+    raceStateVersion++;
+    sendRaceDelta(op, race, raceStateVersion, source);
+}
 
-    broadcastRaceUpdate();
+// Slave: Snapshot beim Master anfordern, begrenzt auf einen pro RACE_SNAPSHOT_REQUEST_MIN_MS
+static void requestRaceSnapshot()
+{
+    unsigned long now = millis();
+    if (lastSnapshotRequestMs != 0 && now - lastSnapshotRequestMs < RACE_SNAPSHOT_REQUEST_MIN_MS)
+        return;
+    lastSnapshotRequestMs = now;
+    snapshotActive = false;
+    sendSnapshotRequest(raceStateVersion);
+}
 
-    // Zähle nur laufende Rennen für die Anzeige
-    int runningRaces = 0;
-    for (const auto &race : raceQueue)
+// Leader-Lease mit Standby
+static void markDevice(const uint8_t *mac, bool online)
+{
+    for (auto *list : {&savedDevices, &discoveredDevices})
     {
-        if (!race.isFinished)
-            runningRaces++;
+        for (auto &dev : *list)
+        {
+            if (memcmp(dev.mac, mac, 6) != 0)
+                continue;
+            dev.isOnline = online;
+            if (online)
+                dev.lastSeen = millis();
+        }
     }
-    wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(runningRaces) + "}");
 }
 
-void masterFinishRace(unsigned long finishTime, const uint8_t *finishDevice, unsigned long localTime)
+// Niedrigste MAC unter den zuletzt gehörten Geräten
+static bool pickStandby(uint8_t out[6])
 {
-    if (!isMaster())
+    unsigned long now = millis();
+    bool found = false;
+    for (auto *list : {&savedDevices, &discoveredDevices})
     {
-        Serial.printf("[MASTER_DEBUG] masterFinishRace aufgerufen, aber dieses Gerät ist nicht Master (Status: %s)\n",
-                      isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
-        return;
+        for (const auto &dev : *list)
+        {
+            if (!dev.isOnline || now - dev.lastSeen > STANDBY_CANDIDATE_MS || memcmp(dev.mac, getMacAddress(), 6) == 0)
+                continue;
+            if (!found || memcmp(dev.mac, out, 6) < 0)
+            {
+                memcpy(out, dev.mac, 6);
+                found = true;
+            }
+        }
     }
+    return found;
+}
 
-    if (raceQueue.empty())
+static void recordTermEvent(Role role, const uint8_t *device, const RaceEventSource *source, int64_t time,
+                            int64_t errorUs, uint8_t channel, uint32_t sensorErrorUs)
+{
+    if (termEventCount == TERM_EVENT_LOG_SIZE)
     {
-        Serial.printf("[MASTER_DEBUG] masterFinishRace: Keine offenen Rennen in der Queue\n");
+        termEventHead = (termEventHead + 1) % TERM_EVENT_LOG_SIZE;
+        termEventCount--;
+        termEventOverflow++;
+    }
+    TermEvent &ev = termEvents[(termEventHead + termEventCount) % TERM_EVENT_LOG_SIZE];
+    termEventCount++;
+    ev.role = role;
+    memcpy(ev.device, device, 6);
+    ev.bootId = source != nullptr ? source->bootId : 0;
+    ev.eventSeq = source != nullptr ? source->eventSeq : 0;
+    ev.time = time;
+    ev.errorUs = errorUs;
+    ev.channel = channel;
+    ev.sensorErrorUs = sensorErrorUs;
+    ev.version = raceStateVersion;
+}
+
+static void clearTermEvents()
+{
+    termEventHead = 0;
+    termEventCount = 0;
+    termEventOverflow = 0;
+    handoverPending = false;
+}
+
+// Split-Brain verloren: Events dieses terms nachliefern, sobald die Uhr zum Gewinner steht
+static void stepDownAsMaster(const uint8_t *winner)
+{
+    // Der eigene Standby hat seine Kopie bis standbyVersion bestätigt, ältere Events kennt er.
+    // Aus dem vollen Log verdrängte Events sind älter als das älteste verbliebene.
+    bool toStandby = hasStandby && memcmp(winner, standbyMac, 6) == 0;
+    uint16_t known = 0;
+    if (toStandby && (termEventCount == 0 || termEvents[termEventHead].version < standbyVersion))
+        termEventOverflow = 0;
+    while (toStandby && termEventCount > 0 && termEvents[termEventHead].version < standbyVersion)
+    {
+        termEventHead = (termEventHead + 1) % TERM_EVENT_LOG_SIZE;
+        termEventCount--;
+        known++;
+    }
+    lostOnStepDownCount += termEventOverflow;
+    handoverPending = termEventCount > 0;
+    handoverSinceMs = millis();
+    Serial.printf("[MASTER_DEBUG] Trete zugunsten von %s zurück: %d Race-Event(s) werden weitergegeben, %d bereits enthalten, %lu verloren (Log voll)\n",
+                  macToString(winner).c_str(), termEventCount, known, (unsigned long)termEventOverflow);
+    termEventOverflow = 0;
+}
+
+// Zurückgetretener Master: gemerkte Events über das Journal an den neuen Master; Duplikate
+// (Event erreichte beide Master) verwirft der neue Master anhand der Event-Kennung
+static void forwardTermEvents()
+{
+    if (millis() - handoverSinceMs > HANDOVER_TIMEOUT_MS)
+    {
+        lostOnStepDownCount += termEventCount;
+        Serial.printf("[MASTER_DEBUG] WARNUNG: Keine Uhr zum neuen Master, %d Race-Event(s) aus dem Split-Brain verloren\n", termEventCount);
+        clearTermEvents();
         return;
     }
 
-    // Berechne Zeit-Offset zwischen Master und Ziel-Gerät
-    if (memcmp(finishDevice, getMacAddress(), 6) != 0)
+    while (termEventCount > 0)
+    {
+        const TermEvent &ev = termEvents[termEventHead];
+        if (!forwardRaceEvent(ev.role, ev.device, ev.bootId, ev.eventSeq, ev.time, ev.errorUs, ev.channel, ev.sensorErrorUs))
+            return; // Noch kein Uhrenmodell des neuen Masters
+        termEventHead = (termEventHead + 1) % TERM_EVENT_LOG_SIZE;
+        termEventCount--;
+        handedOverCount++;
+    }
+    Serial.printf("[MASTER_DEBUG] Race-Events aus dem Split-Brain an %s weitergegeben\n", macToString(masterMac).c_str());
+    handoverPending = false;
+}
+
+static void becomeMaster(const char *reason)
+{
+    // Noch nicht weitergegebene Events gehören zu einer Zeitbasis, die die neue Liste nicht kennt
+    if (handoverPending)
     {
-        // Zeit-Offset: (unsere Zeit) - (lokale Zeit des anderen Geräts)
-        // Dieser Offset wird später zu der anderen Zeit addiert, um sie zu korrigieren
-        long estimatedOffset = (long)millis() - (long)finishTime;
-        updateTimeOffset(finishDevice, estimatedOffset);
-        Serial.printf("[MASTER_DEBUG] Zeit-Offset für Ziel-Gerät %s geschätzt: %ld ms\n",
-                      macToString(finishDevice).c_str(), estimatedOffset);
+        lostOnStepDownCount += termEventCount;
+        Serial.printf("[MASTER_DEBUG] WARNUNG: %d Race-Event(s) aus dem Split-Brain nicht mehr weitergegeben\n", termEventCount);
     }
+    clearTermEvents();
 
-    Serial.printf("[MASTER_DEBUG] masterFinishRace von %s, Zeit: %lu, Queue-Größe: %d\n",
-                  macToString(finishDevice).c_str(), finishTime, raceQueue.size());
+    currentTerm++;
+    hasStandby = false;
+    Serial.printf("[MASTER_DEBUG] Dieses Gerät wird Master (%s), term %lu\n", reason, (unsigned long)currentTerm);
+    setMasterStatus(MASTER_MASTER);
+    memcpy(masterMac, getMacAddress(), 6);
 
-    // Debug: Zeige Status aller Rennen in der Queue
-    Serial.printf("[MASTER_DEBUG] Aktuelle Queue-Inhalte:\n");
-    for (size_t i = 0; i < raceQueue.size(); i++)
+    // Sofort beanspruchen, damit andere Anwärter zurücktreten
+    sendLease(currentTerm, LEASE_DURATION_MS, nullptr, raceStateVersion);
+    lastLeaseSentMs = millis();
+}
+
+static void followMaster(const uint8_t *mac, uint32_t term)
+{
+    bool changed = !isSlave() || memcmp(masterMac, mac, 6) != 0;
+    currentTerm = term;
+    if (!changed)
+        return;
+
+    Serial.printf("[MASTER_DEBUG] Folge Master %s (term %lu)\n", macToString(mac).c_str(), (unsigned long)term);
+    bool wasSlave = isSlave();
+    memcpy(masterMac, mac, 6);
+    setMasterStatus(MASTER_SLAVE);
+    if (wasSlave)
+        broadcastMasterStatus(); // Status gleich, Master neu
+}
+
+// Standby: Lease abgelaufen, Race-Liste und Uhrenmodelle in die eigene Zeit holen und übernehmen
+static void takeOverAsStandby()
+{
+    uint8_t oldMaster[6];
+    memcpy(oldMaster, masterMac, 6);
+    Serial.printf("[MASTER_DEBUG] Lease von %s seit %lu ms abgelaufen, Standby übernimmt\n",
+                  macToString(oldMaster).c_str(), millis() - leaseSeenMs);
+
+    ClockModel oldClock;
+    bool haveClock = getPeerClock(oldMaster, oldClock);
+    int64_t conversionErrorUs = haveClock ? clockErrorAt(oldClock, getTimeUs()) : -1;
+
+    // Die Kopie liegt in der Zeit des alten Masters; beendete Dauern bleiben gültig,
+    // laufende Rennen erben die Unsicherheit der Umrechnung
+    for (uint16_t i = 0; i < raceQueue.size(); i++)
     {
-        const auto &race = raceQueue[i];
-        Serial.printf("[MASTER_DEBUG] Rennen %d: Start=%s, Beendet=%s, Zeit=%lu\n",
-                      i, macToString(race.startDevice).c_str(),
-                      race.isFinished ? "Ja" : "Nein", race.startTime);
+        RaceEntry &race = raceQueue[i];
+        if (race.raceId > nextRaceId)
+            nextRaceId = race.raceId;
+        if (race.isFinished)
+        {
+            if (haveClock)
+            {
+                race.startTime = clockFromReference(oldClock, race.startTime);
+                race.finishTime = clockFromReference(oldClock, race.finishTime);
+            }
+            continue;
+        }
+        int64_t startErrorUs = getRaceErrorUs(race);
+        if (haveClock)
+            race.startTime = clockFromReference(oldClock, race.startTime);
+        race.errorBound = encodeRaceError((startErrorUs < 0 || conversionErrorUs < 0) ? -1 : startErrorUs + conversionErrorUs);
     }
 
-    // Finde das älteste unbeendete Rennen
-    bool foundRace = false;
-    for (auto &race : raceQueue)
+    // Uhrenberichte der Slaves beziehen sich auf den alten Master: über die eigene Uhr verketten
+    portENTER_CRITICAL(&clockMux);
+    for (auto &dc : deviceClocks)
+    {
+        if (!dc.used)
+            continue;
+        if (haveClock)
+            dc.model = chainClockModel(dc.model, oldClock);
+        else
+            dc.used = false;
+    }
+    portEXIT_CRITICAL(&clockMux);
+
+    markDevice(oldMaster, false);
+    failoverCount++;
+    becomeMaster("Standby-Übernahme");
+
+    // Neue Zeitbasis: alle Slaves ersetzen ihre Kopie
+    raceStateVersion++;
+    sendRaceSnapshot(nullptr, raceStateVersion);
+    updateWebSocketClients();
+    Serial.printf("[MASTER_DEBUG] Übernahme abgeschlossen: %d Rennen, Uhr des alten Masters %s\n",
+                  (int)raceQueue.size(), haveClock ? "umgerechnet" : "unbekannt (Zeiten unverändert)");
+}
+
+void checkLeaderLease()
+{
+    unsigned long now = millis();
+
+    if (isMaster())
+    {
+        if (hasStandby && now - standbyAckMs > STANDBY_TIMEOUT_MS)
+        {
+            Serial.printf("[MASTER_DEBUG] Standby %s meldet sich nicht mehr\n", macToString(standbyMac).c_str());
+            markDevice(standbyMac, false);
+            hasStandby = false;
+        }
+        if (!hasStandby && pickStandby(standbyMac))
+        {
+            hasStandby = true;
+            standbyAckMs = now; // Schonfrist bis zum ersten Lebenszeichen
+            standbyVersion = 0;
+            standbyChangeCount++;
+            addDeviceToPeer(standbyMac);
+            Serial.printf("[MASTER_DEBUG] Neuer Standby: %s\n", macToString(standbyMac).c_str());
+        }
+        if (now - lastLeaseSentMs >= LEASE_RENEW_MS)
+        {
+            sendLease(currentTerm, LEASE_DURATION_MS, hasStandby ? standbyMac : nullptr, raceStateVersion);
+            lastLeaseSentMs = now;
+        }
+        return;
+    }
+
+    if (!isSlave())
+        return;
+
+    if (handoverPending)
+        forwardTermEvents();
+
+    unsigned long silentMs = now - leaseSeenMs;
+    if (isStandby())
+    {
+        if (silentMs > leaseDurationMs)
+        {
+            takeOverAsStandby();
+            return;
+        }
+        if (now - lastStandbyAckSentMs >= STANDBY_ACK_MS)
+        {
+            sendStandbyAck(currentTerm, raceStateVersion);
+            lastStandbyAckSentMs = now;
+        }
+    }
+    else if (silentMs > LEASE_ORPHAN_MS)
+    {
+        // Weder Master noch Standby melden sich: Wahl unter den übrigen Geräten
+        Serial.printf("[MASTER_DEBUG] Keine Lease seit %lu ms, bestimme neuen Master\n", silentMs);
+        markDevice(masterMac, false);
+        if (hasStandby)
+            markDevice(standbyMac, false);
+        hasStandby = false;
+        determineMaster();
+        leaseSeenMs = millis();
+    }
+}
+
+void handleLease(const uint8_t *senderMac, uint32_t term, uint16_t leaseMs, const uint8_t *standby, uint32_t stateVersion)
+{
+    if (memcmp(senderMac, getMacAddress(), 6) == 0)
+        return;
+
+    if (isMaster())
     {
-        if (!race.isFinished)
+        // Zwei Master sehen sich: höherer term gewinnt, bei Gleichstand die niedrigere MAC
+        splitBrainCount++;
+        bool otherWins = term > currentTerm || (term == currentTerm && memcmp(senderMac, getMacAddress(), 6) < 0);
+        Serial.printf("[MASTER_DEBUG] Split-Brain: zweiter Master %s (term %lu, eigener term %lu), %s\n",
+                      macToString(senderMac).c_str(), (unsigned long)term, (unsigned long)currentTerm,
+                      otherWins ? "trete zurück" : "bleibe Master");
+        if (!otherWins)
         {
-            foundRace = true;
-            race.isFinished = true;
-            race.finishTime = finishTime;
-            race.finishTimeLocal = localTime;
-            memcpy(race.finishDevice, finishDevice, 6);
+            // Eigene Lease sofort, damit der andere zurücktritt
+            sendLease(currentTerm, LEASE_DURATION_MS, hasStandby ? standbyMac : nullptr, raceStateVersion);
+            lastLeaseSentMs = millis();
+            return;
+        }
+        stepDownAsMaster(senderMac);
+    }
+    else if (term < currentTerm)
+    {
+        return; // Abgesetzter Master, sieht bald die Lease des neuen
+    }
+    else if (isSlave() && term == currentTerm && memcmp(senderMac, masterMac, 6) != 0 &&
+             millis() - leaseSeenMs <= leaseDurationMs)
+    {
+        splitBrainCount++;
+        if (memcmp(senderMac, masterMac, 6) > 0)
+            return; // Bisheriger Master hat die niedrigere MAC
+    }
+
+    bool wasStandby = isStandby();
+    followMaster(senderMac, term);
+    leaseSeenMs = millis();
+    leaseDurationMs = leaseMs;
+    hasStandby = memcmp(standby, "\0\0\0\0\0\0", 6) != 0;
+    if (hasStandby)
+        memcpy(standbyMac, standby, 6);
+    markDevice(senderMac, true);
+
+    if (isStandby() && !wasStandby)
+    {
+        Serial.printf("[MASTER_DEBUG] Dieses Gerät ist Standby für %s\n", macToString(senderMac).c_str());
+        lastStandbyAckSentMs = 0;
+    }
+
+    // Der Standby hält seine Kopie ohne Lücke, sonst wären Rennen bei der Übernahme verloren
+    if (isStandby() && (!replicaValid || memcmp(replicaMasterMac, senderMac, 6) != 0 || stateVersion != raceStateVersion))
+        requestRaceSnapshot();
+}
+
+void handleStandbyAck(const uint8_t *senderMac, uint32_t term, uint32_t stateVersion)
+{
+    if (!isMaster() || !hasStandby || memcmp(senderMac, standbyMac, 6) != 0)
+        return;
+
+    standbyAckMs = millis();
+    standbyVersion = stateVersion;
+    markDevice(senderMac, true);
+    if (term != currentTerm)
+        Serial.printf("[MASTER_DEBUG] Standby meldet term %lu, eigener term %lu\n", (unsigned long)term, (unsigned long)currentTerm);
+}
+
+const uint8_t *getStandbyMac()
+{
+    return hasStandby ? standbyMac : nullptr;
+}
 
-            // Berechne Dauer mit Zeit-Offset-Korrektur
-            long startOffset = getTimeOffset(race.startDevice);
-            long finishOffset = getTimeOffset(finishDevice);
+bool isStandby()
+{
+    return isSlave() && hasStandby && memcmp(standbyMac, getMacAddress(), 6) == 0;
+}
 
-            Serial.printf("[MASTER_DEBUG] Rohe Zeiten: Start=%lu, Ziel=%lu\n", race.startTime, finishTime);
-            Serial.printf("[MASTER_DEBUG] Zeit-Offsets: Start=%ld ms, Ziel=%ld ms\n", startOffset, finishOffset);
+bool isMasterReachable()
+{
+    return isSlave() && millis() - leaseSeenMs <= leaseDurationMs;
+}
 
-            // Korrigiere die Zeiten mit den Offsets
-            long correctedStartTime = (long)race.startTime + startOffset;
-            long correctedFinishTime = (long)finishTime + finishOffset;
+bool hasMasterClock()
+{
+    ClockModel model;
+    return isSlave() && getPeerClock(getMasterMac(), model);
+}
 
-            Serial.printf("[MASTER_DEBUG] Korrigierte Zeiten: Start=%ld, Ziel=%ld\n", correctedStartTime, correctedFinishTime);
+LeaseStatus getLeaseStatus()
+{
+    LeaseStatus status;
+    status.term = currentTerm;
+    status.hasStandby = hasStandby;
+    memcpy(status.standbyMac, standbyMac, 6);
+    status.isStandby = isStandby();
+    status.leaseAgeMs = isMaster() ? millis() - lastLeaseSentMs : millis() - leaseSeenMs;
+    status.standbyVersion = isMaster() ? standbyVersion : raceStateVersion;
+    status.failovers = failoverCount;
+    status.splitBrains = splitBrainCount;
+    status.standbyChanges = standbyChangeCount;
+    status.handedOver = handedOverCount;
+    status.lostOnStepDown = lostOnStepDownCount;
+    return status;
+}
 
-            // Berechne Dauer und verhindere negative Werte
-            long duration = correctedFinishTime - correctedStartTime;
-            if (duration < 0)
+// Race-Management (nur Master)
+void masterAddRaceStart(int64_t startTime, const uint8_t *startDevice, int64_t localTime, uint8_t channel, uint32_t sensorErrorUs, const RaceEventSource *source)
+{
+    if (!isMaster())
+    {
+        Serial.printf("[MASTER_DEBUG] masterAddRaceStart aufgerufen, aber dieses Gerät ist nicht Master (Status: %s)\n",
+                      isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
+        return;
+    }
+
+    // Queue hält nur Master-Zeit, die Umrechnung kommt aus der Uhren-Tabelle
+    int64_t clockErrorUs;
+    startTime = eventToMasterTime(startDevice, startTime, localTime, clockErrorUs, source);
+    recordTermEvent(ROLE_START, startDevice, source, startTime, clockErrorUs, channel, sensorErrorUs);
+
+    RaceEntry entry;
+    entry.startTime = startTime;
+    memcpy(entry.startDevice, startDevice, 6);
+    entry.isFinished = false;
+    entry.finishTime = 0;
+    memset(entry.finishDevice, 0, 6);
+    entry.duration = 0;
+    entry.startChannel = channel;
+    entry.finishChannel = 0;
+    entry.raceId = ++nextRaceId;
+    entry.errorBound = encodeRaceError((clockErrorUs < 0 || sensorErrorUs == SENSOR_ERROR_UNKNOWN) ? -1 : clockErrorUs + sensorErrorUs);
+
+    // Volle Liste: das älteste beendete Rennen weicht, laufende bleiben erhalten
+    if (raceQueue.full())
+    {
+        for (uint16_t i = 0; i < raceQueue.size(); i++)
+        {
+            if (raceQueue[i].isFinished)
             {
-                Serial.printf("[MASTER_DEBUG] WARNUNG: Negative Dauer erkannt! Start: %ld, Ziel: %ld, Dauer: %ld\n",
-                              correctedStartTime, correctedFinishTime, duration);
-                duration = 0; // Setze auf 0 wenn negativ
+                publishRaceDelta(RACE_DELTA_REMOVE, raceQueue[i]);
+                raceQueue.erase(i);
+                break;
             }
-            race.duration = (unsigned long)duration;
+        }
+    }
+    if (!raceQueue.push(entry))
+    {
+        Serial.printf("[MASTER_DEBUG] WARNUNG: %d laufende Rennen, Start von %s verworfen\n",
+                      raceQueue.size(), macToString(startDevice).c_str());
+        return;
+    }
 
-            Serial.printf("[MASTER_DEBUG] Rennen beendet: Start %s (%ld), Ziel %s (%ld), Dauer: %lu ms\n",
-                          macToString(race.startDevice).c_str(), correctedStartTime,
-                          macToString(finishDevice).c_str(), correctedFinishTime,
-                          race.duration);
+    Serial.printf("[MASTER_DEBUG] Rennen gestartet von %s Kanal %d, Zeit: %lld us (Queue-Größe: %d)\n",
+                  macToString(startDevice).c_str(), channel, (long long)startTime, raceQueue.size());
 
-            broadcastRaceUpdate();
-            wsBrodcastMessage("{\"type\":\"lastTime\",\"value\":" + String(race.duration) + "}");
+    publishRaceDelta(RACE_DELTA_ADD, entry, source);
 
-            // Aktualisiere Laufzähler nach dem Beenden des Rennens
-            int runningRaces = 0;
-            for (const auto &raceEntry : raceQueue)
+    // Zähle nur laufende Rennen für die Anzeige
+    wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(raceQueue.runningCount()) + "}");
+}
+
+void masterFinishRace(int64_t finishTime, const uint8_t *finishDevice, int64_t localTime, uint8_t channel, uint32_t sensorErrorUs, const RaceEventSource *source)
+{
+    if (!isMaster())
+    {
+        Serial.printf("[MASTER_DEBUG] masterFinishRace aufgerufen, aber dieses Gerät ist nicht Master (Status: %s)\n",
+                      isMaster() ? "Master" : (isSlave() ? "Slave" : "Unknown"));
+        return;
+    }
+
+    int64_t clockErrorUs;
+    finishTime = eventToMasterTime(finishDevice, finishTime, localTime, clockErrorUs, source);
+    recordTermEvent(ROLE_ZIEL, finishDevice, source, finishTime, clockErrorUs, channel, sensorErrorUs);
+
+    if (raceQueue.empty())
+    {
+        Serial.printf("[MASTER_DEBUG] masterFinishRace: Keine offenen Rennen in der Queue\n");
+        return;
+    }
+
+    Serial.printf("[MASTER_DEBUG] masterFinishRace von %s Kanal %d, Zeit: %lld us, Queue-Größe: %d\n",
+                  macToString(finishDevice).c_str(), channel, (long long)finishTime, raceQueue.size());
+
+    // Debug: Zeige Status aller Rennen in der Queue
+    Serial.printf("[MASTER_DEBUG] Aktuelle Queue-Inhalte:\n");
+    for (uint16_t i = 0; i < raceQueue.size(); i++)
+    {
+        const auto &race = raceQueue[i];
+        Serial.printf("[MASTER_DEBUG] Rennen %d: Start=%s Kanal %d, Beendet=%s, Zeit=%lld us\n",
+                      i, macToString(race.startDevice).c_str(), race.startChannel,
+                      race.isFinished ? "Ja" : "Nein", (long long)race.startTime);
+    }
+
+    // Ältestes unbeendetes Rennen auf derselben Bahn (Kanal), sonst das älteste überhaupt
+    int target = -1;
+    for (uint16_t i = 0; i < raceQueue.size(); i++)
+    {
+        if (!raceQueue[i].isFinished && raceQueue[i].startChannel == channel)
+        {
+            target = i;
+            break;
+        }
+    }
+    if (target < 0)
+    {
+        for (uint16_t i = 0; i < raceQueue.size(); i++)
+        {
+            if (!raceQueue[i].isFinished)
             {
-                if (!raceEntry.isFinished)
-                    runningRaces++;
+                target = i;
+                break;
             }
-            wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(runningRaces) + "}");
+        }
+    }
 
-            break;
+    bool foundRace = false;
+    if (target >= 0)
+    {
+        RaceEntry &race = raceQueue[target];
+        foundRace = true;
+        raceQueue.finish(target);
+        race.finishTime = finishTime;
+        race.finishChannel = channel;
+        memcpy(race.finishDevice, finishDevice, 6);
+
+        // Start und Ziel liegen bereits in Master-Zeit (alles in µs)
+        int64_t duration = finishTime - race.startTime;
+        if (duration < 0)
+        {
+            Serial.printf("[MASTER_DEBUG] WARNUNG: Negative Dauer erkannt! Start: %lld, Ziel: %lld, Dauer: %lld us\n",
+                          (long long)race.startTime, (long long)finishTime, (long long)duration);
+            duration = 0; // Setze auf 0 wenn negativ
         }
+        race.duration = duration;
+        recordRaceDuration(duration);
+
+        // Fehlergrenzen von Start und Ziel addieren sich (Uhr + Abtastung je Seite)
+        int64_t startErrorUs = getRaceErrorUs(race);
+        bool unknown = startErrorUs < 0 || clockErrorUs < 0 || sensorErrorUs == SENSOR_ERROR_UNKNOWN;
+        race.errorBound = encodeRaceError(unknown ? -1 : startErrorUs + clockErrorUs + sensorErrorUs);
+        setLastTime(race.duration, getRaceErrorUs(race));
+
+        Serial.printf("[MASTER_DEBUG] Rennen beendet: Start %s (%lld), Ziel %s (%lld), Dauer: %lld us (±%lld us)\n",
+                      macToString(race.startDevice).c_str(), (long long)race.startTime,
+                      macToString(finishDevice).c_str(), (long long)finishTime,
+                      (long long)race.duration, (long long)getRaceErrorUs(race));
+
+        publishRaceDelta(RACE_DELTA_FINISH, race, source);
+        broadcastLastTime(race.duration, getRaceErrorUs(race));
+
+        // Aktualisiere Laufzähler nach dem Beenden des Rennens
+        wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(raceQueue.runningCount()) + "}");
     }
 
     if (!foundRace)
     {
         Serial.printf("[MASTER_DEBUG] masterFinishRace: Kein offenes Rennen gefunden zum Beenden\n");
         // Sende trotzdem Laufzähler-Update, falls alle Rennen beendet sind
-        int runningRaces = 0;
-        for (const auto &raceEntry : raceQueue)
-        {
-            if (!raceEntry.isFinished)
-                runningRaces++;
-        }
-        wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(runningRaces) + "}");
+        wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(raceQueue.runningCount()) + "}");
     }
 }
 
@@ -893,31 +1721,33 @@ void cleanupFinishedRaces()
 
     // Entferne beendete Rennen, die älter als 15 Sekunden sind (reduziert von 30)
     // ABER: Behalte Rennen mit 0ms Dauer länger, da sie Probleme anzeigen können
-    auto now = millis();
-    auto it = raceQueue.begin();
+    int64_t now = getTimeUs();
+    uint16_t i = 0;
     bool removedAny = false;
 
-    while (it != raceQueue.end())
+    while (i < raceQueue.size())
     {
-        if (it->isFinished && (now - it->finishTime > 15000)) // 15 Sekunden (reduziert)
+        const RaceEntry &race = raceQueue[i];
+        if (race.isFinished && (now - race.finishTime > 15000000)) // 15 Sekunden (reduziert)
         {
             // Spezialbehandlung für Rennen mit 0ms Dauer - behalte sie länger
-            if (it->duration == 0 && (now - it->finishTime < 30000)) // 30 Sekunden für 0ms-Rennen
+            if (race.duration == 0 && (now - race.finishTime < 30000000)) // 30 Sekunden für 0ms-Rennen
             {
-                ++it;
+                ++i;
                 continue;
             }
 
-            Serial.printf("[MASTER_DEBUG] Entferne altes Rennen: Start %s, Ziel %s, Dauer: %lu ms\n",
-                          macToString(it->startDevice).c_str(),
-                          macToString(it->finishDevice).c_str(),
-                          it->duration);
-            it = raceQueue.erase(it);
+            Serial.printf("[MASTER_DEBUG] Entferne altes Rennen: Start %s, Ziel %s, Dauer: %lld us\n",
+                          macToString(race.startDevice).c_str(),
+                          macToString(race.finishDevice).c_str(),
+                          (long long)race.duration);
+            publishRaceDelta(RACE_DELTA_REMOVE, race);
+            raceQueue.erase(i);
             removedAny = true;
         }
         else
         {
-            ++it;
+            ++i;
         }
     }
 
@@ -925,78 +1755,180 @@ void cleanupFinishedRaces()
     if (removedAny)
     {
         Serial.printf("[MASTER_DEBUG] Cleanup abgeschlossen. Neue Queue-Größe: %d\n", raceQueue.size());
-        broadcastRaceUpdate();
 
         // Aktualisiere WebSocket-Clients mit neuem Laufzähler
-        int runningRaces = 0;
-        for (const auto &race : raceQueue)
-        {
-            if (!race.isFinished)
-                runningRaces++;
-        }
-        wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(runningRaces) + "}");
+        wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(raceQueue.runningCount()) + "}");
     }
 }
 
-void broadcastRaceUpdate()
+// Slave: Delta nur auf genau den Vorgänger-Stand anwenden, sonst Snapshot anfordern
+void handleRaceDelta(const uint8_t *senderMac, const RaceDeltaMessage &msg)
 {
-    if (isMaster())
+    if (!isSlave() || memcmp(senderMac, getMasterMac(), 6) != 0)
+        return;
+
+    if (!replicaValid || memcmp(replicaMasterMac, senderMac, 6) != 0 || msg.stateVersion != raceStateVersion + 1)
+    {
+        Serial.printf("[SLAVE_DEBUG] Race-Delta mit Stand %lu passt nicht zu Stand %lu\n",
+                      (unsigned long)msg.stateVersion, (unsigned long)raceStateVersion);
+        requestRaceSnapshot();
+        return;
+    }
+
+    int index = raceQueue.indexOf(msg.raceId);
+
+    // Event-Kennung merken: nach einer Übernahme erkennt dieses Gerät Wiederholungen
+    if (msg.op != RACE_DELTA_REMOVE)
+        rememberRaceEvent(msg.device, msg.bootId, msg.eventSeq);
+
+    if (msg.op == RACE_DELTA_ADD)
+    {
+        RaceEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.raceId = msg.raceId;
+        entry.startTime = msg.time;
+        memcpy(entry.startDevice, msg.device, 6);
+        entry.startChannel = msg.channel;
+        entry.errorBound = msg.errorBound;
+        if (!raceQueue.push(entry))
+        {
+            // Kleinere Kapazität als beim Master: Kopie bleibt unvollständig
+            Serial.printf("[SLAVE_DEBUG] Race-Liste voll (%d), Rennen %u fehlt in der Kopie\n", raceQueue.capacity(), msg.raceId);
+        }
+    }
+    else if (msg.op == RACE_DELTA_FINISH && index >= 0)
     {
-        sendFullSync(); // Verwende Full-Sync statt nur Race-Update
+        RaceEntry &race = raceQueue[index];
+        raceQueue.finish(index);
+        race.finishTime = msg.time;
+        memcpy(race.finishDevice, msg.device, 6);
+        race.finishChannel = msg.channel;
+        race.errorBound = msg.errorBound;
+        race.duration = msg.time > race.startTime ? msg.time - race.startTime : 0; // Wie beim Master
+        recordRaceDuration(race.duration);
     }
+    else if (msg.op == RACE_DELTA_REMOVE && index >= 0)
+    {
+        raceQueue.erase(index);
+    }
+    else
+    {
+        Serial.printf("[SLAVE_DEBUG] Race-Delta %d für unbekanntes Rennen %u\n", msg.op, msg.raceId);
+        requestRaceSnapshot();
+        return;
+    }
+
+    raceStateVersion = msg.stateVersion;
+    updateWebSocketClients();
 }
 
-void handleRaceUpdate(const uint8_t *data, int len)
+// Slave: Snapshot-Teile sammeln, erst der vollständige Snapshot ersetzt die Kopie
+void handleRaceSnapshot(const uint8_t *senderMac, const RaceSnapshotMessage &msg)
 {
-    if (isSlave())
+    if (!isSlave() || memcmp(senderMac, getMasterMac(), 6) != 0)
+        return;
+
+    if (msg.offset == 0)
+    {
+        snapshotStaging.clear();
+        snapshotOverflow = 0;
+        snapshotVersion = msg.stateVersion;
+        snapshotActive = true;
+    }
+    else if (!snapshotActive || msg.stateVersion != snapshotVersion || msg.offset != snapshotStaging.size() + snapshotOverflow)
     {
-        Serial.printf("[SLAVE_DEBUG] Race-Update vom Master empfangen (Länge: %d)\n", len);
+        Serial.println("[SLAVE_DEBUG] Snapshot-Teil außer der Reihe, fordere neu an");
+        snapshotActive = false;
+        requestRaceSnapshot();
+        return;
+    }
 
-        if (len >= sizeof(RaceUpdateMessage))
-        {
-            RaceUpdateMessage msg;
-            memcpy(&msg, data, sizeof(msg));
+    uint8_t count = msg.raceCount > RACE_SYNC_MAX ? RACE_SYNC_MAX : msg.raceCount;
+    for (int i = 0; i < count; i++)
+    {
+        // Rennen über der eigenen Kapazität fehlen in der Kopie, zählen aber für den Fortschritt
+        if (!snapshotStaging.push(msg.races[i]))
+            snapshotOverflow++;
+    }
 
-            // Prüfe, ob die Nachricht vom bekannten Master kommt
-            if (memcmp(msg.masterMac, getMasterMac(), 6) == 0)
-            {
-                // Synchronisiere die Race-Queue komplett mit den Master-Daten
-                raceQueue.clear();
+    if (snapshotStaging.size() + snapshotOverflow < msg.totalCount)
+        return;
 
-                for (int i = 0; i < msg.raceCount; i++)
-                {
-                    raceQueue.push_back(msg.races[i]);
-                }
+    if (snapshotOverflow > 0)
+        Serial.printf("[SLAVE_DEBUG] Snapshot mit %d Rennen, Kapazität %d\n", msg.totalCount, raceQueue.capacity());
+    raceQueue = snapshotStaging;
+    snapshotStaging.clear();
+    snapshotActive = false;
+    raceStateVersion = snapshotVersion;
+    memcpy(replicaMasterMac, senderMac, 6);
+    replicaValid = true;
 
-                Serial.printf("[SLAVE_DEBUG] Race-Queue synchronisiert: %d Rennen vom Master\n", msg.raceCount);
+    int64_t lastFinishedTime = msg.lastFinishedTime;
+    Serial.printf("[SLAVE_DEBUG] Snapshot übernommen: %d Rennen, Stand %lu, letzte Zeit: %lld us\n",
+                  (int)raceQueue.size(), (unsigned long)raceStateVersion, (long long)lastFinishedTime);
 
-                // Aktualisiere WebSocket-Clients mit aktuellen Daten
-                updateWebSocketClients();
-            }
-            else
-            {
-                Serial.printf("[SLAVE_DEBUG] Race-Update von unbekanntem Master ignoriert: %s\n", macToString(msg.masterMac).c_str());
-            }
-        }
+    // Aktualisiere WebSocket-Clients mit allen Daten
+    updateWebSocketClients();
+
+    // Letzte Zeit auch dann, wenn das Rennen schon aus der Liste entfernt wurde
+    if (lastFinishedTime > 0 && getLastTime() != lastFinishedTime)
+    {
+        setLastTime(lastFinishedTime);
+        broadcastLastTime(lastFinishedTime);
     }
 }
 
+void handleSnapshotRequest(const uint8_t *requesterMac, uint32_t haveVersion)
+{
+    if (!isMaster())
+        return;
+
+    Serial.printf("[MASTER_DEBUG] Snapshot angefordert von %s (Stand dort %lu, hier %lu)\n",
+                  macToString(requesterMac).c_str(), (unsigned long)haveVersion, (unsigned long)raceStateVersion);
+    sendRaceSnapshot(requesterMac, raceStateVersion);
+}
+
 // Slave-Funktionen
-void slaveHandleRaceStart(unsigned long startTime, const uint8_t *startDevice, unsigned long localTime)
+void slaveHandleRaceStart(int64_t startTime, const uint8_t *startDevice, int64_t localTime, uint8_t channel, uint32_t sensorErrorUs)
 {
     if (isSlave())
     {
         // Sende Event an Master
-        broadcastRaceEvent(ROLE_START, startTime);
+        broadcastRaceEvent(ROLE_START, startTime, channel, sensorErrorUs);
     }
 }
 
-void slaveHandleRaceFinish(unsigned long finishTime, const uint8_t *finishDevice, unsigned long localTime)
+void slaveHandleRaceFinish(int64_t finishTime, const uint8_t *finishDevice, int64_t localTime, uint8_t channel, uint32_t sensorErrorUs)
 {
     if (isSlave())
     {
         // Sende Event an Master
-        broadcastRaceEvent(ROLE_ZIEL, finishTime);
+        broadcastRaceEvent(ROLE_ZIEL, finishTime, channel, sensorErrorUs);
+    }
+}
+
+// Race-Liste für WebSocket und /api/races; errorUs = -1 wenn die Fehlergrenze unbekannt ist
+void fillRaceListJson(JsonArray races)
+{
+    for (uint16_t i = 0; i < raceQueue.size(); i++)
+    {
+        const RaceEntry &race = raceQueue[i];
+        JsonObject raceObj = races.add<JsonObject>();
+        raceObj["startTime"] = race.startTime;
+        raceObj["startDevice"] = macToString(race.startDevice);
+        raceObj["startChannel"] = race.startChannel;
+        raceObj["isFinished"] = race.isFinished;
+
+        if (race.isFinished)
+        {
+            int64_t errorUs = getRaceErrorUs(race);
+            raceObj["finishTime"] = race.finishTime;
+            raceObj["finishDevice"] = macToString(race.finishDevice);
+            raceObj["finishChannel"] = race.finishChannel;
+            raceObj["duration"] = race.duration;
+            raceObj["errorUs"] = errorUs;
+            raceObj["decimals"] = durationDecimals(errorUs);
+        }
     }
 }
 
@@ -1012,109 +1944,50 @@ void updateWebSocketClients()
     // Sende Zeit-Offset (nur bei Slaves)
     if (isSlave())
     {
-        long offset = getTimeOffset(getMasterMac());
-        wsBrodcastMessage("{\"type\":\"timeOffset\",\"value\":" + String(offset) + "}");
+        JsonDocument offsetDoc;
+        offsetDoc["type"] = "timeOffset";
+        offsetDoc["value"] = getTimeOffset(getMasterMac()); // µs
+        ClockModel model;
+        if (getPeerClock(getMasterMac(), model))
+        {
+            offsetDoc["errorUs"] = clockErrorAt(model, getTimeUs());
+            offsetDoc["skewPpm"] = model.skewPpm;
+        }
+        String offsetJson;
+        serializeJson(offsetDoc, offsetJson);
+        wsBrodcastMessage(offsetJson);
     }
 
     // Sende Laufzähler (nur laufende Rennen)
-    int runningRaces = 0;
-    for (const auto &race : raceQueue)
-    {
-        if (!race.isFinished)
-            runningRaces++;
-    }
-    wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(runningRaces) + "}");
+    wsBrodcastMessage("{\"type\":\"laufCount\",\"value\":" + String(raceQueue.runningCount()) + "}");
 
     // Sende letzte Zeit (letztes beendetes Rennen)
-    for (auto it = raceQueue.rbegin(); it != raceQueue.rend(); ++it)
+    const RaceEntry *last = raceQueue.lastFinished();
+    if (last != nullptr)
     {
-        if (it->isFinished)
+        setLastTime(last->duration, getRaceErrorUs(*last));
+        broadcastLastTime(last->duration, getRaceErrorUs(*last));
+        // Verwende cached role für bessere Performance in häufig aufgerufener Funktion
+        if (roleLoaded && cachedOwnRole == ROLE_DISPLAY)
         {
-            wsBrodcastMessage("{\"type\":\"lastTime\",\"value\":" + String(it->duration) + "}");
-            // Verwende cached role für bessere Performance in häufig aufgerufener Funktion
-            if (roleLoaded && cachedOwnRole == ROLE_DISPLAY)
-            {
-                matrixShowTime(it->duration);
-            }
-            else if (!roleLoaded && getOwnRole() == ROLE_DISPLAY)
-            {
-                // Fallback für den unwahrscheinlichen Fall, dass der Cache noch nicht geladen ist
-                matrixShowTime(it->duration);
-            }
-            break;
+            matrixShowTime(usToMs(last->duration), durationDecimals(getRaceErrorUs(*last)));
+        }
+        else if (!roleLoaded && getOwnRole() == ROLE_DISPLAY)
+        {
+            // Fallback für den unwahrscheinlichen Fall, dass der Cache noch nicht geladen ist
+            matrixShowTime(usToMs(last->duration), durationDecimals(getRaceErrorUs(*last)));
         }
     }
 
     // Sende vollständige Race-Liste als JSON
     JsonDocument doc;
-    JsonArray races = doc.to<JsonArray>();
-
-    for (const auto &race : raceQueue)
-    {
-        JsonObject raceObj = races.add<JsonObject>();
-        raceObj["startTime"] = race.startTime;
-        raceObj["startDevice"] = macToString(race.startDevice);
-        raceObj["isFinished"] = race.isFinished;
-
-        if (race.isFinished)
-        {
-            raceObj["finishTime"] = race.finishTime;
-            raceObj["finishDevice"] = macToString(race.finishDevice);
-            raceObj["duration"] = race.duration;
-        }
-    }
+    fillRaceListJson(doc.to<JsonArray>());
 
     String raceListJson;
     serializeJson(doc, raceListJson);
     wsBrodcastMessage("{\"type\":\"raceList\",\"data\":" + raceListJson + "}");
 }
 
-void handleFullSync(const uint8_t *data, int len)
-{
-    if (isSlave())
-    {
-        Serial.printf("[SLAVE_DEBUG] Full-Sync vom Master empfangen (Länge: %d)\n", len);
-
-        if (len >= sizeof(FullSyncMessage))
-        {
-            FullSyncMessage msg;
-            memcpy(&msg, data, sizeof(msg));
-
-            // Prüfe, ob die Nachricht vom bekannten Master kommt
-            if (memcmp(msg.masterMac, getMasterMac(), 6) == 0)
-            {
-                // Synchronisiere die Race-Queue komplett mit den Master-Daten
-                raceQueue.clear();
-
-                for (int i = 0; i < msg.raceCount; i++)
-                {
-                    raceQueue.push_back(msg.races[i]);
-                }
-
-                // Berechne Zeit-Offset zum Master
-                long timeOffset = msg.masterTime - millis();
-                updateTimeOffset(msg.masterMac, timeOffset);
-
-                Serial.printf("[SLAVE_DEBUG] Full-Sync verarbeitet: %d Rennen, Zeit-Offset: %ld ms, letzte Zeit: %lu ms\n",
-                              msg.raceCount, timeOffset, msg.lastFinishedTime);
-
-                // Aktualisiere WebSocket-Clients mit allen Daten
-                updateWebSocketClients();
-
-                // Sende auch die letzte Zeit, falls vorhanden
-                if (msg.lastFinishedTime > 0)
-                {
-                    wsBrodcastMessage("{\"type\":\"lastTime\",\"value\":" + String(msg.lastFinishedTime) + "}");
-                }
-            }
-            else
-            {
-                Serial.printf("[SLAVE_DEBUG] Full-Sync von unbekanntem Master ignoriert: %s\n", macToString(msg.masterMac).c_str());
-            }
-        }
-    }
-}
-
 void updateDiscoveredDeviceRole(const uint8_t *mac, Role newRole)
 {
     Serial.printf("[ROLE_DEBUG] Aktualisiere Rolle in entdeckten Geräten: MAC %s, neue Rolle %s\n", macToString(mac).c_str(), roleToString(newRole).c_str());
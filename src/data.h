@@ -6,7 +6,6 @@
 #include <Preferences.h>
 #include <vector>
 #include <algorithm>
-#include <deque>
 
 #include "Utility.h"
 #include "deviceInfo.h"
@@ -15,6 +14,47 @@
 #include "Sensor.h"
 #include "server.h"
 #include "anzeige.h"
+#include "timeLogic.h"
+#include "clockSync.h"
+#include "raceStore.h"
+
+#define CLOCK_PEERS_MAX 8
+// Rennen in der Race-Liste (Master und Kopien), fest reserviert
+#ifndef RACE_STORE_CAPACITY
+#define RACE_STORE_CAPACITY 32
+#endif
+#ifndef CLOCK_SYNC_INTERVAL_MS
+#define CLOCK_SYNC_INTERVAL_MS 30000
+#endif
+#define CLOCK_SYNC_FAST_INTERVAL_MS 5000 // Solange die Drift noch nicht geschätzt ist
+#define CLOCK_BURST_SPACING_MS 15
+#define CLOCK_BURST_TIMEOUT_MS 100
+
+// Leader-Lease: Übernahme durch den Standby nach LEASE_DURATION_MS ohne Erneuerung
+#define LEASE_RENEW_MS 200
+#define LEASE_DURATION_MS 800
+#define LEASE_ORPHAN_MS 2500     // Ohne Master und Standby: Wahl unter den übrigen Geräten
+// Split-Brain: als Master verarbeitete Events, die beim Zurücktreten an den Gewinner gehen
+#define TERM_EVENT_LOG_SIZE (2 * RACE_STORE_CAPACITY)
+#define HANDOVER_TIMEOUT_MS (3 * CLOCK_SYNC_FAST_INTERVAL_MS) // Ohne Uhr zum neuen Master danach verloren
+#define STANDBY_ACK_MS 500       // Lebenszeichen des Standbys an den Master
+#define STANDBY_TIMEOUT_MS 2000  // Danach benennt der Master einen neuen Standby
+#define STANDBY_CANDIDATE_MS (2 * CLOCK_SYNC_INTERVAL_MS + 5000) // Zuletzt gehört (Uhrenbericht, Identität)
+
+struct LeaseStatus
+{
+    uint32_t term;
+    bool hasStandby;
+    uint8_t standbyMac[6];
+    bool isStandby;
+    uint32_t leaseAgeMs;     // Master: seit der letzten gesendeten, Slave: seit der letzten empfangenen Lease
+    uint32_t standbyVersion; // Race-Stand des Standbys (Master) bzw. der eigenen Kopie
+    uint32_t failovers;      // Übernahmen als Standby
+    uint32_t splitBrains;    // Leases eines zweiten Masters gesehen
+    uint32_t standbyChanges;
+    uint32_t handedOver;     // Nach verlorenem Split-Brain an den neuen Master weitergegebene Events
+    uint32_t lostOnStepDown; // Dabei verlorene Events (Log voll, keine Uhr zum neuen Master)
+};
 
 Role getOwnRole();
 
@@ -29,12 +69,15 @@ void resetAll();
 // Forward declarations
 void broadcastMasterStatus();
 struct RaceEntry; // Forward declaration für RaceEntry
+struct RaceDeltaMessage;
+struct RaceSnapshotMessage;
+struct RaceEventSource;
 
 struct DeviceInfo
 {
     uint8_t mac[6];
     Role role;
-    long timeOffset;        // Zeit-Offset relativ zum Master in ms
+    int64_t timeOffset;     // Zeit-Offset relativ zum Master in µs
     bool isOnline;          // Ist das Gerät aktuell erreichbar?
     unsigned long lastSeen; // Letzter Kontakt (millis())
 };
@@ -63,55 +106,115 @@ bool changeOtherDevice(const uint8_t *mac, Role role);
 
 void changeOwnRole(Role newRole);
 
-// Sensor Distance Settings Funktionen
-int getMinDistance();
-int getMaxDistance();
-void setMinDistance(int minDistance);
-void setMaxDistance(int maxDistance);
+// Sensor Distance Settings Funktionen (pro Sensor-Kanal)
+int getMinDistance(uint8_t channel = 0);
+int getMaxDistance(uint8_t channel = 0);
+void setMinDistance(int minDistance, uint8_t channel = 0);
+void setMaxDistance(int maxDistance, uint8_t channel = 0);
+
+// Kalibrierter Hintergrund der leeren Bahn (pro Sensor-Kanal)
+float getBaseline(uint8_t channel = 0);
+float getBaselineNoise(uint8_t channel = 0);
+void setBaseline(float backgroundCm, float noiseCm, uint8_t channel = 0);
+
+// Abtastperioden des Sensor-Tasks je Status
+SensorPeriods getSensorPeriods();
+void setSensorPeriods(SensorPeriods periods);
 
-extern std::deque<RaceEntry> raceQueue;
+// Trigger-Filter Einstellungen
+FilterConfig getFilterConfig();
+void setFilterConfig(FilterConfig cfg);
+
+typedef RaceStore<RaceEntry, RACE_STORE_CAPACITY> RaceQueue;
+extern RaceQueue raceQueue;
 extern std::vector<DeviceInfo> savedDevices;
 
-void addRaceStart(unsigned long startTime);
-bool finishRace(unsigned long finishTime, unsigned long &startTime, unsigned long &duration);
+void addRaceStart(int64_t startTime);
+bool finishRace(int64_t finishTime, int64_t &startTime, int64_t &duration);
 
 // Gibt die aktuelle Anzahl laufender Läufe zurück
 int getLaufCount();
 
+// Zeit bis zum nächsten erwarteten Zieleinlauf (µs, negativ = überfällig) aus der
+// typischen Renndauer; Rennen, die mehr als overdueLimitUs überfällig sind, zählen nicht.
+// false ohne laufendes Rennen oder solange noch kein Rennen beendet wurde
+bool getNextExpectedFinishUs(int64_t &remainingUs, int64_t overdueLimitUs);
+
 // Master-System Funktionen
 MasterStatus getMasterStatus();
 void setMasterStatus(MasterStatus status);
 bool isMaster();
 bool isSlave();
 uint8_t *getMasterMac();
+// Startwahl ohne gültige Lease: niedrigste MAC unter den Online-Geräten
 void determineMaster();
 void syncTimeWithMaster();
-void handleMasterHeartbeat(const uint8_t *masterMac, unsigned long masterTime);
-void sendHeartbeat();
-void checkMasterOnline();
+void handleMasterHeartbeat(const uint8_t *masterMac, int64_t masterTime, uint32_t stateVersion);
+void sendHeartbeat(bool bypassQuiet = false);
+
+// Leader-Lease mit Standby; checkLeaderLease läuft im Master-Task
+void checkLeaderLease();
+void handleLease(const uint8_t *senderMac, uint32_t term, uint16_t leaseMs, const uint8_t *standbyMac, uint32_t stateVersion);
+void handleStandbyAck(const uint8_t *senderMac, uint32_t term, uint32_t stateVersion);
+const uint8_t *getStandbyMac(); // nullptr = kein Standby benannt
+bool isStandby();
+bool isMasterReachable(); // Slave: Lease des Masters innerhalb ihrer Laufzeit
+LeaseStatus getLeaseStatus();
+
+// Event-Journal im NVS (Store-and-Forward), Länge in Bytes, 0 = leer
+size_t loadEventJournal(void *buffer, size_t maxLen);
+void saveEventJournal(const void *buffer, size_t len);
 
 // Zeit-Synchronisation
 void requestTimeSync();
-void handleTimeSyncRequest(const uint8_t *requesterMac, unsigned long requesterTime);
-void handleTimeSyncResponse(const uint8_t *masterMac, unsigned long masterTime, unsigned long roundTripTime);
-long getTimeOffset(const uint8_t *deviceMac);
-void updateTimeOffset(const uint8_t *deviceMac, long offset);
+void handleTimeSyncRequest(const uint8_t *requesterMac, int64_t requesterTime, int64_t receiveTime, unsigned long sequenceNumber);
+void handleTimeSyncResponse(const uint8_t *masterMac, int64_t t1, int64_t t2, int64_t t3, int64_t t4, unsigned long sequenceNumber);
+unsigned long getClockSyncIntervalMs();
+bool hasMasterClock(); // Slave: Uhrenmodell zum aktuellen Master vorhanden
+
+// Uhrenmodelle pro Gegenstelle (Offset + Drift + Fehlergrenze)
+bool getPeerClock(const uint8_t *mac, ClockModel &model);
+int getPeerClocks(uint8_t macs[][6], ClockModel *models, int maxCount);
+int64_t localToMasterTime(int64_t localUs);
+
+// Master: Uhrenmodelle der Slaves (Gerätezeit -> Master-Zeit), nur aus ClockReports
+void handleClockReport(const uint8_t *deviceMac, const ClockModel &model);
+bool getDeviceClock(const uint8_t *deviceMac, ClockModel &model, int64_t &updatedUs);
+int getDeviceClocks(uint8_t macs[][6], ClockModel *models, int64_t *updatedUs, int maxCount);
+bool deviceToMasterTime(const uint8_t *deviceMac, int64_t deviceUs, int64_t &masterUs, int64_t &errorUs);
+int64_t getTimeOffset(const uint8_t *deviceMac);
+void updateTimeOffset(const uint8_t *deviceMac, int64_t offset);
 
 // Race-Management (nur Master)
-void masterAddRaceStart(unsigned long startTime, const uint8_t *startDevice, unsigned long localTime);
-void masterFinishRace(unsigned long finishTime, const uint8_t *finishDevice, unsigned long localTime);
-void broadcastRaceUpdate();
-void handleRaceUpdate(const uint8_t *data, int len);
-void handleFullSync(const uint8_t *data, int len);
+// Alle Zeiten in µs, Event-Zeiten in der Uhr des auslösenden Geräts;
+// die Queue speichert sie in Master-Zeit
+// channel = Sensor-Kanal des auslösenden Geräts, sensorErrorUs = Abtast-Unsicherheit der Event-Zeit
+// source = auslösendes Race-Event eines Slaves, geht für den Standby mit ins Delta
+void masterAddRaceStart(int64_t startTime, const uint8_t *startDevice, int64_t localTime, uint8_t channel = 0, uint32_t sensorErrorUs = 0, const RaceEventSource *source = nullptr);
+void masterFinishRace(int64_t finishTime, const uint8_t *finishDevice, int64_t localTime, uint8_t channel = 0, uint32_t sensorErrorUs = 0, const RaceEventSource *source = nullptr);
+
+// Replikation der Race-Liste: Deltas mit fortlaufendem Stand, Snapshot bei Lücken
+uint32_t getRaceStateVersion();
+void handleRaceDelta(const uint8_t *senderMac, const RaceDeltaMessage &msg);
+void handleRaceSnapshot(const uint8_t *senderMac, const RaceSnapshotMessage &msg);
+void handleSnapshotRequest(const uint8_t *requesterMac, uint32_t haveVersion);
 void cleanupFinishedRaces();
 
 // Slave-Funktionen
-void slaveHandleRaceStart(unsigned long startTime, const uint8_t *startDevice, unsigned long localTime);
-void slaveHandleRaceFinish(unsigned long finishTime, const uint8_t *finishDevice, unsigned long localTime);
+void slaveHandleRaceStart(int64_t startTime, const uint8_t *startDevice, int64_t localTime, uint8_t channel = 0, uint32_t sensorErrorUs = 0);
+void slaveHandleRaceFinish(int64_t finishTime, const uint8_t *finishDevice, int64_t localTime, uint8_t channel = 0, uint32_t sensorErrorUs = 0);
+
+// Fehlergrenze einer Dauer in µs, -1 wenn unbekannt
+int64_t getRaceErrorUs(const RaceEntry &race);
 
 // WebSocket-Updates
+void fillRaceListJson(JsonArray races);
 void updateWebSocketClients();
 
+// Cluster-ID im WireHeader, trennt Anlagen auf demselben Funkkanal
+uint16_t getClusterId();
+void setClusterId(uint16_t clusterId);
+
 // Brightness functions for display devices
 int getBrightness();
 void setBrightness(int brightness);
@@ -1,15 +1,13 @@
 #include <espnow.h>
 #include <data.h>
 #include <server.h>
+#include <timeLogic.h>
+#include <spscRing.h>
 #include <algorithm>
 #include <set>
 
-void handleSaveDeviceMessage(const uint8_t *incomingData)
+void handleSaveDeviceMessage(const SaveDeviceMessage &msg)
 {
-    SaveDeviceMessage msg;
-
-    memcpy(&msg, incomingData, sizeof(msg));
-
     // WebSocket-Updates senden
     String json = "{\"mac\":\"" + macToString(msg.targetMac) + "\",\"role\":\"" + roleToString(msg.targetRole) + "\"}";
     wsBrodcastMessage("{\"type\":\"device\",\"data\":" + json + "}");
@@ -43,127 +41,1201 @@ void handleSaveDeviceMessage(const uint8_t *incomingData)
     }
 }
 
-void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+// Radio-Timing: Empfangs-Zeitstempel und Sendedauer bis zur Bestätigung
+static EspNowTimingStats espNowTiming;
+static portMUX_TYPE txMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Sendezeitpunkte in Reihenfolge; onDataSend kommt in derselben Reihenfolge.
+// Jeder Eintrag trägt eine Kennung, ein abgelehnter Frame entfernt genau seinen
+// eigenen Eintrag, auch wenn dazwischen andere eingereiht oder bestätigt wurden.
+#define TX_PENDING_MAX 16
+struct TxPending
+{
+    int64_t sentUs;
+    uint32_t tag;
+};
+static TxPending txPending[TX_PENDING_MAX];
+static uint8_t txPendingHead = 0;
+static uint8_t txPendingCount = 0;
+static uint32_t txPendingNextTag = 0;
+
+// Nur unter txMux aufrufen; false wenn der Eintrag schon entnommen wurde
+static bool removeTxPending(uint32_t tag)
+{
+    for (uint8_t i = 0; i < txPendingCount; i++)
+    {
+        if (txPending[(txPendingHead + i) % TX_PENDING_MAX].tag != tag)
+            continue;
+        for (uint8_t j = i; j + 1 < txPendingCount; j++)
+            txPending[(txPendingHead + j) % TX_PENDING_MAX] = txPending[(txPendingHead + j + 1) % TX_PENDING_MAX];
+        txPendingCount--;
+        return true;
+    }
+    return false;
+}
+
+static uint16_t txSequence = 0;
+
+const uint8_t ESPNOW_BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Spiegel der IDF-Peer-Tabelle mit Nutzungszeit für die LRU-Verdrängung.
+// Die IDF-Aufrufe laufen außerhalb des Critical Sections.
+struct PeerSlot
+{
+    bool used;
+    bool pinned;
+    uint8_t mac[6];
+    uint32_t lastUsedMs; // Letztes Senden oder Empfangen (millis())
+    uint8_t inFlight;    // Gesendet, onDataSend steht noch aus
+    uint32_t lastSendMs;
+};
+
+static PeerSlot peerSlots[ESPNOW_PEER_MAX];
+static EspNowPeerStats peerStats;
+static portMUX_TYPE peerMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Nur unter peerMux aufrufen
+static PeerSlot *findPeerSlot(const uint8_t *mac)
+{
+    for (auto &slot : peerSlots)
+    {
+        if (slot.used && memcmp(slot.mac, mac, 6) == 0)
+            return &slot;
+    }
+    return nullptr;
+}
+
+static void touchPeer(const uint8_t *mac)
+{
+    portENTER_CRITICAL(&peerMux);
+    PeerSlot *slot = findPeerSlot(mac);
+    if (slot != nullptr)
+        slot->lastUsedMs = millis();
+    portEXIT_CRITICAL(&peerMux);
+}
+
+// Empfangene Frames vom WiFi-Task (Produzent) an espNowRxTask (Konsument)
+struct RxFrame
+{
+    int64_t rxTimeUs;
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[ESPNOW_MAX_FRAME];
+};
+
+static SpscRing<RxFrame, ESPNOW_RX_QUEUE_SIZE> rxFrames;
+static TaskHandle_t espNowRxTaskHandle = NULL;
+
+void fillWireHeader(WireHeader &header, uint8_t type, size_t length)
 {
-    if (len == 9 && memcmp(incomingData, "WHOAREYOU", 9) == 0)
+    header.magic = WIRE_MAGIC;
+    header.version = WIRE_VERSION;
+    header.type = type;
+    header.length = (uint8_t)length;
+    header.cluster = getClusterId();
+    portENTER_CRITICAL(&txMux);
+    header.sequence = ++txSequence;
+    portEXIT_CRITICAL(&txMux);
+}
+
+// Ausgehender Frame, wartet in der Queue seiner Klasse auf den EspNowTx-Task
+struct TxFrame
+{
+    int64_t queuedUs;
+    uint8_t mac[6];
+    uint8_t len;
+    int16_t stampOffset; // -1 = kein Sendezeitstempel
+    bool sending;        // Vom Task entnommen, wird nicht mehr ersetzt
+    bool bypassQuiet;    // Geht auch im Ruhefenster raus
+    uint8_t data[ESPNOW_MAX_FRAME];
+};
+
+struct TxQueue
+{
+    TxFrame *frames;
+    uint8_t capacity;
+    uint8_t count;
+    EspNowTxClassStats stats;
+};
+
+static TxFrame txRaceFrames[ESPNOW_TX_QUEUE_RACE];
+static TxFrame txSyncFrames[ESPNOW_TX_QUEUE_SYNC];
+static TxFrame txStateFrames[ESPNOW_TX_QUEUE_STATE];
+static TxFrame txDiscoveryFrames[ESPNOW_TX_QUEUE_DISCOVERY];
+
+// Reihenfolge = Priorität; alles unter txMux
+static TxQueue txQueues[TX_CLASS_COUNT] = {
+    {txRaceFrames, ESPNOW_TX_QUEUE_RACE, 0, {}},
+    {txSyncFrames, ESPNOW_TX_QUEUE_SYNC, 0, {}},
+    {txStateFrames, ESPNOW_TX_QUEUE_STATE, 0, {}},
+    {txDiscoveryFrames, ESPNOW_TX_QUEUE_DISCOVERY, 0, {}},
+};
+
+static TaskHandle_t espNowTxTaskHandle = NULL;
+
+// Ruhefenster: Beginn in millis(), 0 = aus; alles unter txMux
+static uint32_t quietSinceMs = 0;
+
+// Nur unter txMux aufrufen; ein vergessenes Ruhefenster endet nach ESPNOW_QUIET_MAX_MS
+static bool quietHolds(uint8_t txClass)
+{
+    if (quietSinceMs == 0 || txClass < TX_CLASS_STATE)
+        return false;
+    if (millis() - quietSinceMs > ESPNOW_QUIET_MAX_MS)
     {
-        sendIdentity(mac);
+        quietSinceMs = 0;
+        return false;
     }
-    else if (len == sizeof(DeviceInfo) || len == sizeof(SaveDeviceMessage))
+    return true;
+}
+
+static TxClass txClassOf(uint8_t type)
+{
+    switch (type)
+    {
+    case MSG_TYPE_RACE_EVENT:
+    case MSG_TYPE_RACE_EVENT_ACK:
+    case MSG_TYPE_RACE_DELTA:
+        return TX_CLASS_RACE;
+    case MSG_TYPE_TIME_SYNC_REQUEST:
+    case MSG_TYPE_TIME_SYNC_RESPONSE:
+    case MSG_TYPE_CLOCK_REPORT:
+    case MSG_TYPE_LEASE:
+    case MSG_TYPE_STANDBY_ACK:
+        return TX_CLASS_SYNC;
+    case MSG_TYPE_HEARTBEAT:
+    case MSG_TYPE_RACE_SNAPSHOT:
+    case MSG_TYPE_SNAPSHOT_REQUEST:
+        return TX_CLASS_STATE;
+    default:
+        return TX_CLASS_DISCOVERY;
+    }
+}
+
+// Zustandsnachrichten, bei denen nur der neueste Stand pro Empfänger zählt
+static bool txSupersedes(uint8_t type)
+{
+    return type == MSG_TYPE_HEARTBEAT || type == MSG_TYPE_CLOCK_REPORT || type == MSG_TYPE_SNAPSHOT_REQUEST ||
+           type == MSG_TYPE_DISCOVERY || type == MSG_TYPE_IDENTITY || type == MSG_TYPE_LEASE ||
+           type == MSG_TYPE_STANDBY_ACK;
+}
+
+const char *txClassToString(uint8_t txClass)
+{
+    switch (txClass)
+    {
+    case TX_CLASS_RACE:
+        return "race";
+    case TX_CLASS_SYNC:
+        return "sync";
+    case TX_CLASS_STATE:
+        return "state";
+    case TX_CLASS_DISCOVERY:
+        return "discovery";
+    default:
+        return "unknown";
+    }
+}
+
+esp_err_t espNowSend(const uint8_t *mac, const uint8_t *data, size_t len, int stampOffset, bool bypassQuiet)
+{
+    if (len < sizeof(WireHeader) || len > ESPNOW_MAX_FRAME)
+        return ESP_ERR_INVALID_ARG;
+
+    addDeviceToPeer(mac);
+
+    uint8_t type = ((const WireHeader *)data)->type;
+    TxQueue &queue = txQueues[txClassOf(type)];
+    int64_t now = getTimeUs();
+
+    portENTER_CRITICAL(&txMux);
+    TxFrame *frame = nullptr;
+    if (txSupersedes(type))
     {
-        // Da beide Messages die gleiche Größe haben, prüfen wir das messageType Feld
-        SaveDeviceMessage *saveMsg = (SaveDeviceMessage *)incomingData;
-        if (saveMsg->messageType == MSG_TYPE_SAVE_DEVICE)
+        // Noch nicht gesendeten älteren Stand an denselben Empfänger überschreiben
+        for (uint8_t i = 0; i < queue.count; i++)
         {
-            handleSaveDeviceMessage(incomingData);
+            TxFrame &f = queue.frames[i];
+            if (!f.sending && ((const WireHeader *)f.data)->type == type && memcmp(f.mac, mac, 6) == 0)
+            {
+                frame = &f;
+                bypassQuiet = bypassQuiet || f.bypassQuiet; // Ersetzter Stand behält seinen Vorrang
+                queue.stats.coalesced++;
+                break;
+            }
         }
+    }
+    if (frame == nullptr && queue.count < queue.capacity)
+    {
+        frame = &queue.frames[queue.count++];
+        frame->queuedUs = now;
+        frame->sending = false;
+        memcpy(frame->mac, mac, 6);
+        queue.stats.queued++;
+        if (queue.count > queue.stats.highWater)
+            queue.stats.highWater = queue.count;
+    }
+    if (frame != nullptr)
+    {
+        frame->len = len;
+        frame->stampOffset = stampOffset;
+        frame->bypassQuiet = bypassQuiet;
+        memcpy(frame->data, data, len);
+    }
+    else
+    {
+        queue.stats.dropped++;
+    }
+    portEXIT_CRITICAL(&txMux);
+
+    if (frame == nullptr)
+    {
+        Serial.printf("[ESP_NOW_ERROR] Sende-Queue %s voll, Frame an %s verworfen\n",
+                      txClassToString(txClassOf(type)), macToString(mac).c_str());
+        return ESP_ERR_ESPNOW_NO_MEM;
+    }
+    if (espNowTxTaskHandle != NULL)
+        xTaskNotifyGive(espNowTxTaskHandle);
+    return ESP_OK;
+}
+
+// Nur der EspNowTx-Task fragt ab und zählt hoch, onDataSend zählt herunter
+static bool peerCanSend(const uint8_t *mac)
+{
+    bool canSend = true;
+    portENTER_CRITICAL(&peerMux);
+    PeerSlot *slot = findPeerSlot(mac);
+    if (slot != nullptr && slot->inFlight >= ESPNOW_TX_INFLIGHT_PER_PEER)
+    {
+        if (millis() - slot->lastSendMs > ESPNOW_TX_INFLIGHT_TIMEOUT_MS)
+            slot->inFlight = 0;
         else
+            canSend = false;
+    }
+    portEXIT_CRITICAL(&peerMux);
+    return canSend;
+}
+
+static void peerInFlight(const uint8_t *mac, int delta)
+{
+    portENTER_CRITICAL(&peerMux);
+    PeerSlot *slot = findPeerSlot(mac);
+    if (slot != nullptr)
+    {
+        if (delta > 0)
         {
-            // Es ist eine DeviceInfo-Nachricht
-            DeviceInfo msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            handleIdentityMessage(msg.mac, msg.role);
+            slot->inFlight++;
+            slot->lastSendMs = millis();
+        }
+        else if (slot->inFlight > 0)
+        {
+            slot->inFlight--;
         }
     }
-    else if (len == sizeof(RaceEventMessage))
+    portEXIT_CRITICAL(&peerMux);
+}
+
+// Ersten sendbaren Frame der höchsten Klasse markieren und kopieren. Frames an
+// einen ausgelasteten Peer werden übersprungen, die Reihenfolge pro Peer bleibt.
+static bool takeTxFrame(TxFrame &out, uint8_t &txClass)
+{
+    bool found = false;
+    portENTER_CRITICAL(&txMux);
+    for (uint8_t c = 0; c < TX_CLASS_COUNT && !found; c++)
     {
-        RaceEventMessage msg;
-        memcpy(&msg, incomingData, sizeof(msg));
+        // Im Ruhefenster warten niedrigere Klassen, außer Frames mit bypassQuiet
+        bool held = quietHolds(c);
+        TxQueue &queue = txQueues[c];
+        for (uint8_t i = 0; i < queue.count; i++)
+        {
+            if ((held && !queue.frames[i].bypassQuiet) || !peerCanSend(queue.frames[i].mac))
+                continue;
+            queue.frames[i].sending = true;
+            out = queue.frames[i];
+            txClass = c;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&txMux);
+    return found;
+}
 
-        if (isMaster())
+// Gesendeten Frame entfernen (done) oder für einen neuen Versuch freigeben
+static void finishTxFrame(uint8_t txClass, bool done, int64_t latencyUs)
+{
+    portENTER_CRITICAL(&txMux);
+    TxQueue &queue = txQueues[txClass];
+    for (uint8_t i = 0; i < queue.count; i++)
+    {
+        if (!queue.frames[i].sending)
+            continue;
+        if (done)
         {
-            // Master verarbeitet Race-Events
-            if (msg.senderRole == ROLE_START)
-            {
-                masterAddRaceStart(msg.eventTime, msg.senderMac, msg.localTime);
-            }
-            else if (msg.senderRole == ROLE_ZIEL)
-            {
-                masterFinishRace(msg.eventTime, msg.senderMac, msg.localTime);
-            }
+            for (uint8_t j = i + 1; j < queue.count; j++)
+                queue.frames[j - 1] = queue.frames[j];
+            queue.count--;
+            queue.stats.sent++;
+            queue.stats.latencySumUs += latencyUs;
+            if (latencyUs > queue.stats.maxLatencyUs)
+                queue.stats.maxLatencyUs = latencyUs;
         }
         else
         {
-            // Slaves leiten Race-Events an Master weiter (falls nötig)
+            queue.frames[i].sending = false;
+            queue.stats.noMemRetries++;
+        }
+        break;
+    }
+    portEXIT_CRITICAL(&txMux);
+}
+
+// Sendet einen Frame; false wenn nichts sendbar ist oder der Funk-Puffer voll ist
+static bool sendNextTxFrame()
+{
+    static TxFrame frame; // Nur dieser Task, nicht auf dem Stack
+    uint8_t txClass;
+    if (!takeTxFrame(frame, txClass))
+        return false;
+
+    int64_t now = getTimeUs();
+    if (frame.stampOffset >= 0)
+        memcpy(frame.data + frame.stampOffset, &now, sizeof(now));
+
+    portENTER_CRITICAL(&txMux);
+    bool tracked = txPendingCount < TX_PENDING_MAX;
+    uint32_t tag = txPendingNextTag++;
+    if (tracked)
+    {
+        TxPending &p = txPending[(txPendingHead + txPendingCount) % TX_PENDING_MAX];
+        p.sentUs = now;
+        p.tag = tag;
+        txPendingCount++;
+    }
+    portEXIT_CRITICAL(&txMux);
+
+    peerInFlight(frame.mac, 1);
+    esp_err_t result = esp_now_send(frame.mac, frame.data, frame.len);
+    if (result != ESP_OK)
+        peerInFlight(frame.mac, -1); // Kein Callback für abgelehnte Frames
+
+    portENTER_CRITICAL(&txMux);
+    if (result != ESP_OK && tracked)
+        removeTxPending(tag);
+    if (result != ESP_ERR_ESPNOW_NO_MEM)
+    {
+        espNowTiming.txFrames++;
+        if (memcmp(frame.mac, ESPNOW_BROADCAST_MAC, 6) == 0)
+            espNowTiming.txBroadcasts++;
+        if (result != ESP_OK)
+            espNowTiming.txErrors++;
+    }
+    portEXIT_CRITICAL(&txMux);
+
+    // Voller Funk-Puffer: Frame bleibt vorne in der Queue, neuer Versuch nach onDataSend
+    bool noMem = result == ESP_ERR_ESPNOW_NO_MEM;
+    finishTxFrame(txClass, !noMem, now - frame.queuedUs);
+    if (result != ESP_OK && !noMem)
+        Serial.printf("[ESP_NOW_ERROR] esp_now_send an %s fehlgeschlagen: %d\n", macToString(frame.mac).c_str(), result);
+    return !noMem;
+}
+
+static void espNowTxTask(void *pvParameters)
+{
+    for (;;)
+    {
+        // Geweckt durch neue Frames oder onDataSend; Timeout für NO_MEM und hängende Peers
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ESPNOW_TX_RETRY_MS));
+        while (sendNextTxFrame())
+        {
+        }
+    }
+}
+
+void setEspNowQuiet(bool quiet)
+{
+    portENTER_CRITICAL(&txMux);
+    bool changed = quiet != (quietSinceMs != 0);
+    if (quiet && quietSinceMs == 0)
+    {
+        quietSinceMs = millis() | 1; // 0 ist "aus"
+        espNowTiming.quietWindows++;
+    }
+    else if (!quiet)
+    {
+        quietSinceMs = 0;
+    }
+    portEXIT_CRITICAL(&txMux);
+
+    // Zurückgehaltene Frames sofort senden
+    if (changed && !quiet && espNowTxTaskHandle != NULL)
+        xTaskNotifyGive(espNowTxTaskHandle);
+}
+
+void getEspNowTxClassStats(EspNowTxClassStats *out)
+{
+    portENTER_CRITICAL(&txMux);
+    for (uint8_t c = 0; c < TX_CLASS_COUNT; c++)
+    {
+        out[c] = txQueues[c].stats;
+        out[c].depth = txQueues[c].count;
+    }
+    portEXIT_CRITICAL(&txMux);
+}
+
+EspNowTimingStats getEspNowTimingStats()
+{
+    portENTER_CRITICAL(&txMux);
+    EspNowTimingStats stats = espNowTiming;
+    stats.quiet = quietSinceMs != 0 && millis() - quietSinceMs <= ESPNOW_QUIET_MAX_MS;
+    portEXIT_CRITICAL(&txMux);
+    stats.rxQueueDepth = rxFrames.size();
+    stats.rxQueueHighWater = rxFrames.highWaterMark();
+    stats.rxDropped = rxFrames.droppedCount();
+    return stats;
+}
+
+// Läuft im WiFi-Task: nur Zeitstempel, Kopie in die Queue und Wecken des
+// Protokoll-Tasks. Kein Serial, kein JSON, kein NVS.
+void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len)
+{
+    // Zeitstempel vor jeder Verarbeitung, damit Sync und Latenzmessung nicht jittern
+    int64_t rxTimeUs = getTimeUs();
+
+    if (len <= 0 || len > ESPNOW_MAX_FRAME)
+        return;
+
+    RxFrame frame;
+    frame.rxTimeUs = rxTimeUs;
+    memcpy(frame.mac, mac, 6);
+    frame.len = len;
+    memcpy(frame.data, incomingData, len);
+    if (rxFrames.push(frame) && espNowRxTaskHandle != NULL)
+        xTaskNotifyGive(espNowRxTaskHandle);
+}
+
+static void espNowRxTask(void *pvParameters)
+{
+    RxFrame frame;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (rxFrames.pop(frame))
+        {
+            handleEspNowFrame(frame.mac, frame.data, frame.len, frame.rxTimeUs);
+
+            // Vom Empfang im Callback bis zum Ende der Verarbeitung, inklusive Wartezeit in der Queue
+            int64_t handlingUs = getTimeUs() - frame.rxTimeUs;
+            portENTER_CRITICAL(&txMux);
+            espNowTiming.rxFrames++;
+            espNowTiming.rxHandlingSumUs += handlingUs;
+            if (handlingUs > espNowTiming.maxRxHandlingUs)
+                espNowTiming.maxRxHandlingUs = handlingUs;
+            portEXIT_CRITICAL(&txMux);
         }
     }
-    else if (len == sizeof(MasterHeartbeatMessage) || len == sizeof(TimeSyncRequestMessage))
+}
+
+// Zuverlässige Race-Events: Der Dispatcher legt das Event im Journal ab und sendet
+// sofort; Wiederholungen, Zwischenspeichern bei Master-Ausfall und das Nachliefern
+// übernimmt raceEventRetryTask.
+struct JournalEntry
+{
+    bool used;
+    RaceEventMessage msg;
+    uint8_t attempts;     // Versuche seit der letzten Erreichbarkeit des Masters
+    bool journaled;       // Hat einen Ausfall überdauert (bzw. aus dem NVS geladen)
+    uint32_t backoffMs;
+    unsigned long nextRetryMs;
+};
+
+// Zähler und Duplikat-Fenster pro Gegenstelle; Schlüssel ist (bootId, eventSeq),
+// damit nachgelieferte Events aus einem früheren Start das Fenster nicht leeren
+struct RaceLinkPeer
+{
+    bool used;
+    RaceLinkStats stats;
+    uint32_t recentBoot[RACE_EVENT_DEDUPE_WINDOW];
+    uint16_t recentSeq[RACE_EVENT_DEDUPE_WINDOW];
+    uint8_t recentCount;
+    uint8_t recentHead;
+};
+
+static JournalEntry raceJournal[RACE_JOURNAL_SIZE];
+static RaceJournalStats journalStats;
+static bool journalDirty = false;    // Unterscheidet sich vom NVS-Stand
+static uint8_t journalPersisted = 0; // Einträge im NVS
+static RaceJournalBlob journalBlob;  // Puffer für NVS, nur Init und Retry-Task
+static RaceLinkPeer raceLinkPeers[RACE_LINK_PEERS_MAX];
+static portMUX_TYPE raceLinkMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t raceEventRetryTaskHandle = NULL;
+static uint32_t raceEventBootId = 0;
+static uint16_t raceEventSeq = 0;
+
+// Aufruf nur innerhalb von raceLinkMux; bei voller Tabelle nullptr
+static RaceLinkPeer *findRaceLinkPeer(const uint8_t *mac)
+{
+    RaceLinkPeer *freeSlot = nullptr;
+    for (auto &peer : raceLinkPeers)
+    {
+        if (peer.used && memcmp(peer.stats.mac, mac, 6) == 0)
+            return &peer;
+        if (!peer.used && freeSlot == nullptr)
+            freeSlot = &peer;
+    }
+    if (freeSlot != nullptr)
     {
-        // Prüfe Message-Typ erst, dann handle entsprechend
-        uint8_t messageType = incomingData[0];
+        memset(freeSlot, 0, sizeof(*freeSlot));
+        freeSlot->used = true;
+        memcpy(freeSlot->stats.mac, mac, 6);
+    }
+    return freeSlot;
+}
 
-        if (messageType == MSG_TYPE_HEARTBEAT && len == sizeof(MasterHeartbeatMessage))
+// Master: true beim ersten Empfang, false für ein bereits verarbeitetes Event.
+// count = false: nur ins Fenster aufnehmen (Standby), Zähler bleiben unverändert
+static bool acceptRaceEvent(const uint8_t *senderMac, uint32_t bootId, uint16_t eventSeq, bool count = true)
+{
+    bool accept = true;
+    portENTER_CRITICAL(&raceLinkMux);
+    RaceLinkPeer *peer = findRaceLinkPeer(senderMac);
+    if (peer != nullptr)
+    {
+        for (uint8_t i = 0; i < peer->recentCount; i++)
         {
-            // Serial.printf("[ESP_NOW_DEBUG] MasterHeartbeatMessage empfangen\n");
-            MasterHeartbeatMessage msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            handleMasterHeartbeat(msg.masterMac, msg.masterTime);
+            if (peer->recentSeq[i] == eventSeq && peer->recentBoot[i] == bootId)
+            {
+                accept = false;
+                break;
+            }
         }
-        else if (messageType == MSG_TYPE_TIME_SYNC_REQUEST && len == sizeof(TimeSyncRequestMessage))
+        if (accept)
         {
-            TimeSyncRequestMessage msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            handleTimeSyncRequest(msg.requesterMac, msg.requestTime);
+            peer->recentBoot[peer->recentHead] = bootId;
+            peer->recentSeq[peer->recentHead] = eventSeq;
+            peer->recentHead = (peer->recentHead + 1) % RACE_EVENT_DEDUPE_WINDOW;
+            if (peer->recentCount < RACE_EVENT_DEDUPE_WINDOW)
+                peer->recentCount++;
+            if (count)
+                peer->stats.received++;
         }
-        else
+        else if (count)
         {
-            Serial.printf("[ESP_NOW_DEBUG] Unbekannter Message-Typ: %d, Länge: %d\n", messageType, len);
+            peer->stats.duplicates++;
         }
     }
-    else if (len == sizeof(TimeSyncResponseMessage))
+    portEXIT_CRITICAL(&raceLinkMux);
+    return accept;
+}
+
+void rememberRaceEvent(const uint8_t *senderMac, uint32_t bootId, uint16_t eventSeq)
+{
+    if (eventSeq != 0)
+        acceptRaceEvent(senderMac, bootId, eventSeq, false);
+}
+
+// Slave: ACK vom Master entfernt das Event aus dem Journal
+static void handleRaceEventAck(const uint8_t *masterMac, uint32_t bootId, uint16_t eventSeq)
+{
+    portENTER_CRITICAL(&raceLinkMux);
+    for (auto &entry : raceJournal)
     {
-        // Prüfe Message-Typ
-        uint8_t messageType = incomingData[0];
-        if (messageType == MSG_TYPE_TIME_SYNC_RESPONSE)
+        if (entry.used && entry.msg.eventSeq == eventSeq && entry.msg.bootId == bootId)
         {
-            TimeSyncResponseMessage msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            unsigned long roundTripTime = millis() - msg.originalRequestTime;
-            handleTimeSyncResponse(msg.masterMac, msg.masterTime, roundTripTime);
+            entry.used = false;
+            journalDirty = true;
+            if (entry.journaled)
+                journalStats.drained++;
+            RaceLinkPeer *peer = findRaceLinkPeer(masterMac);
+            if (peer != nullptr)
+                peer->stats.acked++;
+            break;
         }
+    }
+    portEXIT_CRITICAL(&raceLinkMux);
+}
+
+// Sendet einen Versuch; localTime wird pro Versuch neu gesetzt (Verweildauer beim Sender)
+static void sendPendingRaceEvent(RaceEventMessage msg, bool retry)
+{
+    uint8_t target[6];
+    memcpy(target, getMasterMac(), 6); // Master kann zwischen Versuchen wechseln
+
+    // Events aus einem früheren Start: Verweildauer über den Neustart ist nicht messbar
+    if (msg.bootId != raceEventBootId && !(msg.flags & RACE_EVENT_FORWARDED))
+        msg.flags |= RACE_EVENT_PREVIOUS_BOOT;
+
+    portENTER_CRITICAL(&raceLinkMux);
+    RaceLinkPeer *peer = findRaceLinkPeer(target);
+    if (peer != nullptr)
+    {
+        if (retry)
+            peer->stats.retries++;
         else
+            peer->stats.sent++;
+    }
+    portEXIT_CRITICAL(&raceLinkMux);
+
+    // localTime setzt der Sende-Task bei jedem Versuch neu
+    sendMessage(target, msg, offsetof(RaceEventMessage, localTime));
+}
+
+// Beste verfügbare Übersetzung in Master-Zeit zum Zeitpunkt des Events; der Master
+// nutzt sie, wenn ihm kein Uhrenmodell des Slaves vorliegt oder der Slave neu gestartet ist
+static void translateRaceEvent(RaceEventMessage &msg)
+{
+    ClockModel model;
+    memset(msg.translatedBy, 0, 6);
+    msg.masterEventTime = 0;
+    msg.translationErrorUs = UINT32_MAX;
+    if (!isSlave() || !getPeerClock(getMasterMac(), model))
+        return;
+
+    int64_t errorUs = clockErrorAt(model, msg.eventTime);
+    memcpy(msg.translatedBy, getMasterMac(), 6);
+    msg.masterEventTime = clockToReference(model, msg.eventTime);
+    msg.translationErrorUs = errorUs < 0 || errorUs > UINT32_MAX - 1 ? UINT32_MAX : (uint32_t)errorUs;
+}
+
+// Legt ein Event ins Journal und sendet den ersten Versuch; assignId vergibt eine eigene Kennung
+static void journalRaceEvent(RaceEventMessage &msg, bool assignId)
+{
+    unsigned long now = millis();
+    bool overflow = false;
+
+    portENTER_CRITICAL(&raceLinkMux);
+    if (assignId)
+    {
+        msg.bootId = raceEventBootId;
+        msg.eventSeq = ++raceEventSeq;
+    }
+
+    // Freier Eintrag, sonst das älteste Event opfern: neuere Events sind wertvoller
+    JournalEntry *slot = nullptr;
+    for (auto &entry : raceJournal)
+    {
+        if (!entry.used)
         {
-            // Unbekannter Message-Typ
+            slot = &entry;
+            break;
         }
     }
-    else if (len == sizeof(RaceUpdateMessage))
+    if (slot == nullptr)
     {
-        // Prüfe Message-Typ
-        uint8_t messageType = incomingData[0];
-        if (messageType == MSG_TYPE_RACE_UPDATE)
+        for (auto &entry : raceJournal)
         {
-            RaceUpdateMessage msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            handleRaceUpdate((uint8_t *)&msg, len);
+            // Events früherer Starts zuerst, sonst die kleinste Nummer des laufenden Starts
+            bool entryOld = entry.msg.bootId != raceEventBootId;
+            bool slotOld = slot != nullptr && slot->msg.bootId != raceEventBootId;
+            if (slot == nullptr || (entryOld && !slotOld) ||
+                (entryOld == slotOld && (int16_t)(entry.msg.eventSeq - slot->msg.eventSeq) < 0))
+                slot = &entry;
         }
-        else
+        overflow = true;
+        journalStats.overflows++;
+        RaceLinkPeer *peer = findRaceLinkPeer(getMasterMac());
+        if (peer != nullptr)
+            peer->stats.lost++;
+    }
+    slot->used = true;
+    slot->msg = msg;
+    slot->attempts = 1;
+    slot->journaled = false;
+    slot->backoffMs = RACE_EVENT_RETRY_MS;
+    slot->nextRetryMs = now + RACE_EVENT_RETRY_MS;
+    journalDirty = true;
+    portEXIT_CRITICAL(&raceLinkMux);
+
+    if (overflow)
+        Serial.println("[ESP_NOW_ERROR] Event-Journal voll, ältestes Race-Event verworfen");
+
+    // Ohne erreichbaren Master nur ablegen, der Retry-Task liefert nach
+    if (isMasterReachable())
+        sendPendingRaceEvent(msg, false);
+    if (raceEventRetryTaskHandle != NULL)
+        xTaskNotifyGive(raceEventRetryTaskHandle); // Wartezeit neu berechnen, ggf. speichern
+}
+
+static void queueRaceEvent(RaceEventMessage &msg)
+{
+    translateRaceEvent(msg);
+    msg.flags = 0;
+    journalRaceEvent(msg, true);
+}
+
+bool forwardRaceEvent(Role role, const uint8_t *device, uint32_t bootId, uint16_t eventSeq, int64_t eventTime,
+                      int64_t errorUs, uint8_t channel, uint32_t sensorErrorUs)
+{
+    ClockModel model;
+    if (!isSlave() || !getPeerClock(getMasterMac(), model))
+        return false;
+
+    RaceEventMessage msg;
+    msg.senderRole = role;
+    msg.eventTime = eventTime;
+    memcpy(msg.senderMac, eventSeq == 0 ? getMacAddress() : device, 6);
+    msg.channel = channel;
+    msg.sensorErrorUs = sensorErrorUs;
+    msg.bootId = bootId;
+    msg.eventSeq = eventSeq;
+
+    // eventTime liegt nicht auf der Uhr von device: nur die Übersetzung ist gültig.
+    // Unbekannte Fehlergrenzen werden zur größten darstellbaren (UINT32_MAX heißt "keine Übersetzung").
+    int64_t modelErrorUs = clockErrorAt(model, eventTime);
+    int64_t totalUs = (errorUs < 0 || modelErrorUs < 0) ? -1 : errorUs + modelErrorUs;
+    memcpy(msg.translatedBy, getMasterMac(), 6);
+    msg.masterEventTime = clockToReference(model, eventTime);
+    msg.translationErrorUs = (totalUs < 0 || totalUs > UINT32_MAX - 1) ? UINT32_MAX - 1 : (uint32_t)totalUs;
+    msg.flags = RACE_EVENT_FORWARDED;
+
+    journalRaceEvent(msg, eventSeq == 0);
+    return true;
+}
+
+// Neuer Master (Übernahme als Standby): eigene offene Events direkt verarbeiten
+static void deliverJournalLocally()
+{
+    for (;;)
+    {
+        RaceEventMessage msg;
+        bool found = false;
+        portENTER_CRITICAL(&raceLinkMux);
+        for (auto &entry : raceJournal)
+        {
+            if (entry.used)
+            {
+                msg = entry.msg;
+                entry.used = false;
+                journalDirty = true;
+                found = true;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&raceLinkMux);
+        if (!found)
+            return;
+
+        RaceEventSource source = {msg.bootId, msg.eventSeq};
+        if (msg.flags & RACE_EVENT_FORWARDED)
         {
-            Serial.printf("[ESP_NOW_DEBUG] Unbekannter TimeSyncResponse Message-Typ: %d\n", messageType);
+            // Weitergegebenes Event: über die Übersetzung auf den alten Master zurück in eigene Zeit
+            ClockModel model;
+            if (!getPeerClock(msg.translatedBy, model))
+            {
+                journalStats.stale++;
+                continue;
+            }
+            int64_t modelErrorUs = clockErrorAt(model, getTimeUs());
+            source.hasTranslation = true;
+            source.previousBoot = true;
+            source.masterTime = clockFromReference(model, msg.masterEventTime);
+            source.masterErrorUs = modelErrorUs < 0 ? -1 : msg.translationErrorUs + modelErrorUs;
         }
+        else if (msg.bootId != raceEventBootId)
+        {
+            // Events aus früheren Starts haben keine Zeitbasis auf der eigenen Uhr mehr
+            journalStats.stale++;
+            continue;
+        }
+        // Der alte Master kann das Event noch verarbeitet haben, dann kam es per Delta mit
+        if (!acceptRaceEvent(msg.senderMac, msg.bootId, msg.eventSeq))
+            continue;
+
+        Serial.printf("[ESP_NOW_DEBUG] Race-Event %u von %s nach Übernahme lokal verarbeitet\n", msg.eventSeq, macToString(msg.senderMac).c_str());
+        if (msg.senderRole == ROLE_START)
+            masterAddRaceStart(msg.eventTime, msg.senderMac, getTimeUs(), msg.channel, msg.sensorErrorUs, &source);
+        else if (msg.senderRole == ROLE_ZIEL)
+            masterFinishRace(msg.eventTime, msg.senderMac, getTimeUs(), msg.channel, msg.sensorErrorUs, &source);
     }
-    else if (len == sizeof(FullSyncMessage))
+}
+
+// Offene Events ins NVS, damit ein Neustart während eines Ausfalls nichts kostet.
+// Schreibt nur, solange der Master fehlt oder das NVS noch Einträge hält: Flash-Schreiben
+// hält beide Kerne kurz an und soll im Normalbetrieb nicht in die Messung fallen.
+static void persistJournal(bool reachable)
+{
+    RaceJournalBlob &blob = journalBlob;
+    portENTER_CRITICAL(&raceLinkMux);
+    bool write = journalDirty && (!reachable || journalPersisted > 0);
+    if (write)
     {
-        // Prüfe Message-Typ
-        uint8_t messageType = incomingData[0];
-        if (messageType == MSG_TYPE_FULL_SYNC)
+        blob.wireVersion = WIRE_VERSION;
+        blob.count = 0;
+        for (const auto &entry : raceJournal)
         {
-            FullSyncMessage msg;
-            memcpy(&msg, incomingData, sizeof(msg));
-            handleFullSync((uint8_t *)&msg, len);
+            if (entry.used)
+                blob.events[blob.count++] = entry.msg;
         }
-        else
+        journalDirty = false;
+    }
+    portEXIT_CRITICAL(&raceLinkMux);
+
+    if (!write)
+        return;
+    saveEventJournal(&blob, offsetof(RaceJournalBlob, events) + blob.count * sizeof(RaceEventMessage));
+    journalPersisted = blob.count;
+    journalStats.persists++;
+}
+
+static void loadJournal()
+{
+    RaceJournalBlob &blob = journalBlob;
+    size_t len = loadEventJournal(&blob, sizeof(blob));
+    if (len < offsetof(RaceJournalBlob, events) || blob.wireVersion != WIRE_VERSION ||
+        blob.count > RACE_JOURNAL_SIZE || len != offsetof(RaceJournalBlob, events) + blob.count * sizeof(RaceEventMessage))
+        return;
+
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < blob.count; i++)
+    {
+        JournalEntry &entry = raceJournal[i];
+        entry.used = true;
+        entry.msg = blob.events[i];
+        entry.attempts = 0;
+        entry.journaled = true;
+        entry.backoffMs = RACE_EVENT_RETRY_MS;
+        entry.nextRetryMs = now;
+    }
+    journalPersisted = blob.count;
+    journalStats.restored = blob.count;
+    if (blob.count > 0)
+        Serial.printf("[ESP_NOW_DEBUG] %d Race-Event(s) aus dem Journal geladen\n", blob.count);
+}
+
+// Wartet bis zur nächsten fälligen Wiederholung oder bis ein neues Event kommt.
+// Ohne erreichbaren Master bleiben die Events im Journal; kommt er zurück (oder ein
+// neuer), gehen sie in Reihenfolge und höchstens RACE_JOURNAL_DRAIN_BURST auf einmal raus.
+static void raceEventRetryTask(void *pvParameters)
+{
+    bool wasReachable = true;
+    for (;;)
+    {
+        unsigned long now = millis();
+        bool reachable = isMasterReachable();
+        TickType_t wait = portMAX_DELAY;
+        RaceEventMessage due[RACE_JOURNAL_DRAIN_BURST];
+        uint8_t dueCount = 0;
+        uint8_t parkedCount = 0;
+        bool pending = false;
+
+        if (isMaster())
+            deliverJournalLocally();
+
+        portENTER_CRITICAL(&raceLinkMux);
+        for (auto &entry : raceJournal)
+        {
+            if (!entry.used)
+                continue;
+            pending = true;
+
+            if (!reachable)
+            {
+                if (!entry.journaled)
+                {
+                    entry.journaled = true;
+                    journalStats.journaled++;
+                    journalDirty = true;
+                }
+                continue;
+            }
+            if (!wasReachable)
+            {
+                // Verbindung zurück: sofort nachliefern, Backoff von vorn
+                entry.attempts = 0;
+                entry.backoffMs = RACE_EVENT_RETRY_MS;
+                entry.nextRetryMs = now;
+            }
+
+            if ((long)(now - entry.nextRetryMs) >= 0 && dueCount < RACE_JOURNAL_DRAIN_BURST)
+            {
+                if (entry.attempts >= RACE_EVENT_MAX_ATTEMPTS && !entry.journaled)
+                {
+                    // Master hört, bestätigt aber nicht: ab jetzt als zwischengespeichert führen
+                    entry.journaled = true;
+                    journalStats.journaled++;
+                    parkedCount++;
+                }
+
+                // Exponentieller Backoff mit Zufallsanteil, damit sich Sender nicht synchronisieren
+                entry.attempts++;
+                entry.backoffMs = entry.backoffMs * 2 > RACE_EVENT_RETRY_MAX_MS ? RACE_EVENT_RETRY_MAX_MS : entry.backoffMs * 2;
+                entry.nextRetryMs = now + entry.backoffMs + esp_random() % (entry.backoffMs / 4 + 1);
+                due[dueCount++] = entry.msg;
+            }
+
+            TickType_t remaining = (long)(entry.nextRetryMs - now) > 0 ? pdMS_TO_TICKS(entry.nextRetryMs - now) + 1 : pdMS_TO_TICKS(RACE_EVENT_RETRY_MS);
+            if (wait == portMAX_DELAY || remaining < wait)
+                wait = remaining;
+        }
+        portEXIT_CRITICAL(&raceLinkMux);
+
+        // Erreichbarkeit des Masters abfragen, solange Events warten
+        if (pending && !reachable)
+            wait = pdMS_TO_TICKS(RACE_JOURNAL_POLL_MS);
+        if (!wasReachable && reachable && pending)
+            Serial.println("[ESP_NOW_DEBUG] Master wieder erreichbar, liefere Race-Events aus dem Journal nach");
+        wasReachable = reachable;
+
+        if (parkedCount > 0)
+            Serial.printf("[ESP_NOW_ERROR] %d Race-Event(s) nach %d Versuchen ohne ACK, bleiben im Journal\n", parkedCount, RACE_EVENT_MAX_ATTEMPTS);
+        for (uint8_t i = 0; i < dueCount; i++)
         {
-            Serial.printf("[ESP_NOW_DEBUG] Unbekannter FullSync Message-Typ: %d\n", messageType);
+            Serial.printf("[ESP_NOW_DEBUG] Race-Event %u ohne ACK, wiederhole\n", due[i].eventSeq);
+            sendPendingRaceEvent(due[i], true);
         }
+
+        persistJournal(reachable);
+        ulTaskNotifyTake(pdTRUE, wait);
     }
-    else
+}
+
+RaceJournalStats getRaceJournalStats()
+{
+    portENTER_CRITICAL(&raceLinkMux);
+    RaceJournalStats stats = journalStats;
+    stats.depth = 0;
+    for (const auto &entry : raceJournal)
+        stats.depth += entry.used ? 1 : 0;
+    portEXIT_CRITICAL(&raceLinkMux);
+    stats.capacity = RACE_JOURNAL_SIZE;
+    stats.persisted = journalPersisted;
+    return stats;
+}
+
+int getRaceLinkStats(RaceLinkStats *out, int maxCount)
+{
+    int count = 0;
+    portENTER_CRITICAL(&raceLinkMux);
+    for (const auto &peer : raceLinkPeers)
+    {
+        if (peer.used && count < maxCount)
+            out[count++] = peer.stats;
+    }
+    portEXIT_CRITICAL(&raceLinkMux);
+    return count;
+}
+
+// Handler bekommen eine Sicht direkt auf den Frame-Puffer (gepackt, keine Kopie)
+template <typename T>
+static const T &frameAs(const uint8_t *frame)
+{
+    return *reinterpret_cast<const T *>(frame);
+}
+
+static void onDiscoveryFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    sendIdentity(mac);
+}
+
+static void onIdentityFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const IdentityMessage &msg = frameAs<IdentityMessage>(frame);
+    handleIdentityMessage(msg.mac, msg.role);
+}
+
+static void onSaveDeviceFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    handleSaveDeviceMessage(frameAs<SaveDeviceMessage>(frame));
+}
+
+static void onRaceEventFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const RaceEventMessage &msg = frameAs<RaceEventMessage>(frame);
+    if (!isMaster())
+        return; // Slaves werten Race-Events nicht aus
+
+    // Jedes Event bestätigen, auch Duplikate: das erste ACK kann verloren gegangen sein
+    RaceEventAckMessage ack;
+    memcpy(ack.masterMac, getMacAddress(), 6);
+    ack.bootId = msg.bootId;
+    ack.eventSeq = msg.eventSeq;
+    sendMessage(mac, ack);
+
+    if (!acceptRaceEvent(msg.senderMac, msg.bootId, msg.eventSeq))
     {
-        Serial.printf("[ESP_NOW_DEBUG] Unbekannte Nachrichtenlänge: %d bytes\n", len);
+        Serial.printf("[ESP_NOW_DEBUG] Doppeltes Race-Event %u von %s verworfen\n", msg.eventSeq, macToString(msg.senderMac).c_str());
+        return;
     }
+
+    // Master verarbeitet Race-Events; die Event-Kennung geht mit dem Delta an den Standby.
+    // Die Übersetzung des Senders zählt nur, wenn sie auf unsere Uhr gerechnet wurde.
+    // Weitergegebene Events liegen nicht auf der Uhr des Geräts, wie bei einem früheren Start
+    RaceEventSource source = {msg.bootId, msg.eventSeq};
+    source.previousBoot = (msg.flags & (RACE_EVENT_PREVIOUS_BOOT | RACE_EVENT_FORWARDED)) != 0;
+    if (msg.translationErrorUs != UINT32_MAX && memcmp(msg.translatedBy, getMacAddress(), 6) == 0)
+    {
+        source.hasTranslation = true;
+        source.masterTime = msg.masterEventTime;
+        source.masterErrorUs = msg.translationErrorUs;
+    }
+    if (source.previousBoot && !source.hasTranslation)
+    {
+        // Gerätezeit eines vergangenen Starts lässt sich nicht mehr umrechnen
+        portENTER_CRITICAL(&raceLinkMux);
+        RaceLinkPeer *peer = findRaceLinkPeer(msg.senderMac);
+        if (peer != nullptr)
+            peer->stats.stale++;
+        portEXIT_CRITICAL(&raceLinkMux);
+        Serial.printf("[ESP_NOW_ERROR] Race-Event %u von %s aus früherem Start ohne Zeitbasis verworfen\n", msg.eventSeq, macToString(msg.senderMac).c_str());
+        return;
+    }
+    if (msg.senderRole == ROLE_START)
+    {
+        masterAddRaceStart(msg.eventTime, msg.senderMac, msg.localTime, msg.channel, msg.sensorErrorUs, &source);
+    }
+    else if (msg.senderRole == ROLE_ZIEL)
+    {
+        masterFinishRace(msg.eventTime, msg.senderMac, msg.localTime, msg.channel, msg.sensorErrorUs, &source);
+    }
+}
+
+static void onRaceEventAckFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const RaceEventAckMessage &msg = frameAs<RaceEventAckMessage>(frame);
+    handleRaceEventAck(msg.masterMac, msg.bootId, msg.eventSeq);
+}
+
+static void onHeartbeatFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const MasterHeartbeatMessage &msg = frameAs<MasterHeartbeatMessage>(frame);
+    handleMasterHeartbeat(msg.masterMac, msg.masterTime, msg.stateVersion);
+}
+
+static void onTimeSyncRequestFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const TimeSyncRequestMessage &msg = frameAs<TimeSyncRequestMessage>(frame);
+    handleTimeSyncRequest(msg.requesterMac, msg.requestTime, rxTimeUs, msg.sequenceNumber); // t2
+}
+
+static void onTimeSyncResponseFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const TimeSyncResponseMessage &msg = frameAs<TimeSyncResponseMessage>(frame);
+    handleTimeSyncResponse(msg.masterMac, msg.originalRequestTime, msg.receiveTime, msg.masterTime, rxTimeUs, msg.sequenceNumber); // t4
+}
+
+static void onClockReportFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const ClockReportMessage &msg = frameAs<ClockReportMessage>(frame);
+
+    ClockModel model;
+    resetClockModel(model);
+    model.valid = true;
+    model.refLocalUs = msg.refLocalUs;
+    model.offsetUs = msg.offsetUs;
+    model.skewPpm = msg.skewPpm;
+    model.skewValid = msg.skewValid;
+    model.skewErrorPpm = msg.skewErrorPpm;
+    model.baseErrorUs = msg.baseErrorUs;
+    model.bursts = msg.bursts;
+    handleClockReport(msg.deviceMac, model);
+}
+
+static void onRaceDeltaFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    handleRaceDelta(mac, frameAs<RaceDeltaMessage>(frame));
+}
+
+static void onRaceSnapshotFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    handleRaceSnapshot(mac, frameAs<RaceSnapshotMessage>(frame));
+}
+
+static void onSnapshotRequestFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    handleSnapshotRequest(mac, frameAs<SnapshotRequestMessage>(frame).haveVersion);
+}
+
+static void onLeaseFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const LeaseMessage &msg = frameAs<LeaseMessage>(frame);
+    handleLease(msg.masterMac, msg.term, msg.leaseMs, msg.standbyMac, msg.stateVersion);
+}
+
+static void onStandbyAckFrame(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs)
+{
+    const StandbyAckMessage &msg = frameAs<StandbyAckMessage>(frame);
+    handleStandbyAck(mac, msg.term, msg.stateVersion);
+}
+
+typedef void (*FrameHandler)(const uint8_t *mac, const uint8_t *frame, int64_t rxTimeUs);
+
+struct FrameRoute
+{
+    uint8_t length; // Erwartete Gesamtlänge des Frames
+    FrameHandler handler;
+};
+
+// Index = MSG_TYPE_*, Reihenfolge muss zu den Typ-Nummern passen
+static const FrameRoute frameRoutes[MSG_TYPE_COUNT] = {
+    {0, nullptr},                                                 // 0: nicht vergeben
+    {sizeof(MasterHeartbeatMessage), onHeartbeatFrame},           // MSG_TYPE_HEARTBEAT
+    {sizeof(TimeSyncRequestMessage), onTimeSyncRequestFrame},     // MSG_TYPE_TIME_SYNC_REQUEST
+    {sizeof(TimeSyncResponseMessage), onTimeSyncResponseFrame},   // MSG_TYPE_TIME_SYNC_RESPONSE
+    {sizeof(RaceDeltaMessage), onRaceDeltaFrame},                 // MSG_TYPE_RACE_DELTA
+    {sizeof(RaceSnapshotMessage), onRaceSnapshotFrame},           // MSG_TYPE_RACE_SNAPSHOT
+    {sizeof(SaveDeviceMessage), onSaveDeviceFrame},               // MSG_TYPE_SAVE_DEVICE
+    {sizeof(RaceEventMessage), onRaceEventFrame},                 // MSG_TYPE_RACE_EVENT
+    {sizeof(ClockReportMessage), onClockReportFrame},             // MSG_TYPE_CLOCK_REPORT
+    {sizeof(DiscoveryMessage), onDiscoveryFrame},                 // MSG_TYPE_DISCOVERY
+    {sizeof(IdentityMessage), onIdentityFrame},                   // MSG_TYPE_IDENTITY
+    {sizeof(RaceEventAckMessage), onRaceEventAckFrame},           // MSG_TYPE_RACE_EVENT_ACK
+    {sizeof(SnapshotRequestMessage), onSnapshotRequestFrame},     // MSG_TYPE_SNAPSHOT_REQUEST
+    {sizeof(LeaseMessage), onLeaseFrame},                         // MSG_TYPE_LEASE
+    {sizeof(StandbyAckMessage), onStandbyAckFrame},               // MSG_TYPE_STANDBY_ACK
+};
+
+void handleEspNowFrame(const uint8_t *mac, const uint8_t *incomingData, int len, int64_t rxTimeUs)
+{
+    // Header prüfen, dann ein Tabellenzugriff: Typ und exakte Länge müssen passen
+    const WireHeader *header = (const WireHeader *)incomingData;
+    bool valid = len >= (int)sizeof(WireHeader) && header->magic == WIRE_MAGIC && header->version == WIRE_VERSION &&
+                 header->type < MSG_TYPE_COUNT && header->length == len;
+    const FrameRoute *route = valid ? &frameRoutes[header->type] : nullptr;
+    if (route == nullptr || route->handler == nullptr || route->length != len)
+    {
+        portENTER_CRITICAL(&txMux);
+        espNowTiming.rxRejected++;
+        portEXIT_CRITICAL(&txMux);
+        Serial.printf("[ESP_NOW_DEBUG] Frame verworfen von %s: Typ %d, Version %d, Länge %d bytes\n",
+                      macToString(mac).c_str(), len >= (int)sizeof(WireHeader) ? header->type : -1,
+                      len >= (int)sizeof(WireHeader) ? header->version : -1, len);
+        return;
+    }
+
+    if (header->cluster != getClusterId())
+    {
+        portENTER_CRITICAL(&txMux);
+        espNowTiming.rxForeignCluster++;
+        portEXIT_CRITICAL(&txMux);
+        return;
+    }
+
+    touchPeer(mac);
+    route->handler(mac, incomingData, rxTimeUs);
 }
 
 void onDataSend(const uint8_t *mac, esp_now_send_status_t status)
 {
+    int64_t doneUs = getTimeUs();
+    portENTER_CRITICAL(&txMux);
+    if (txPendingCount > 0)
+    {
+        int64_t airUs = doneUs - txPending[txPendingHead].sentUs;
+        txPendingHead = (txPendingHead + 1) % TX_PENDING_MAX;
+        txPendingCount--;
+        espNowTiming.txCompleted++;
+        espNowTiming.txCompleteSumUs += airUs;
+        if (airUs > espNowTiming.maxTxCompleteUs)
+            espNowTiming.maxTxCompleteUs = airUs;
+    }
+    if (status != ESP_NOW_SEND_SUCCESS)
+        espNowTiming.txFailed++;
+    portEXIT_CRITICAL(&txMux);
+
+    peerInFlight(mac, -1);
+    if (espNowTxTaskHandle != NULL)
+        xTaskNotifyGive(espNowTxTaskHandle);
+
     // Nur Fehler loggen, Erfolg stumm
     if (status != ESP_NOW_SEND_SUCCESS)
     {
@@ -173,19 +1245,11 @@ void onDataSend(const uint8_t *mac, esp_now_send_status_t status)
 
 void sendIdentity(const uint8_t *dest)
 {
-    DeviceInfo msg;
+    IdentityMessage msg;
     memcpy(msg.mac, getMacAddress(), 6);
     msg.role = getOwnRole();
 
-    esp_now_peer_info_t peerInfo = {};
-    memcpy(peerInfo.peer_addr, dest, 6);
-    peerInfo.channel = ESP_NOW_CHANNEL;
-    peerInfo.encrypt = false;
-    if (!esp_now_is_peer_exist(dest))
-    {
-        esp_now_add_peer(&peerInfo);
-    }
-    esp_err_t result = esp_now_send(dest, (uint8_t *)&msg, sizeof(msg));
+    esp_err_t result = sendMessage(dest, msg);
     if (result != ESP_OK)
     {
         Serial.printf("[ESP_NOW_ERROR] Identität senden fehlgeschlagen: %d\n", result);
@@ -195,32 +1259,19 @@ void sendIdentity(const uint8_t *dest)
 
 void sendDiscoveryMessage()
 {
-    uint8_t broadcastMac[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    addDeviceToPeer(broadcastMac);
-    esp_now_send(broadcastMac, (uint8_t *)"WHOAREYOU", 9);
-    removeDeviceFromPeer(broadcastMac);
+    DiscoveryMessage msg;
+    sendToCluster(msg);
 }
 
 bool tellOtherDeviceToChangeHisRole(const uint8_t *targetMac, Role newRole)
 {
     SaveDeviceMessage msg;
-    msg.messageType = MSG_TYPE_SAVE_DEVICE;
     memcpy(msg.targetMac, targetMac, 6);
     msg.targetRole = newRole;
     memcpy(msg.senderMac, getMacAddress(), 6);
     msg.senderRole = getOwnRole();
 
-    esp_now_peer_info_t peerInfo = {};
-
-    memcpy(peerInfo.peer_addr, targetMac, 6);
-    peerInfo.channel = ESP_NOW_CHANNEL;
-    peerInfo.encrypt = false;
-    if (!esp_now_is_peer_exist(targetMac))
-    {
-        esp_now_add_peer(&peerInfo);
-    }
-
-    esp_err_t result = esp_now_send(targetMac, (uint8_t *)&msg, sizeof(msg));
+    esp_err_t result = sendMessage(targetMac, msg);
     if (result == ESP_OK)
     {
         return true;
@@ -261,17 +1312,11 @@ void tellOthersMyRoleChanged()
 
 void sendGoodBye(const uint8_t *mac)
 {
-    DeviceInfo msg;
+    IdentityMessage msg;
     WiFi.macAddress(msg.mac);
     msg.role = ROLE_IGNORE;
 
-    esp_now_peer_info_t peerInfo = {};
-    memcpy(peerInfo.peer_addr, mac, 6);
-    peerInfo.channel = ESP_NOW_CHANNEL;
-    peerInfo.encrypt = false;
-    esp_now_add_peer(&peerInfo);
-
-    esp_err_t result = esp_now_send(mac, (uint8_t *)&msg, sizeof(msg));
+    esp_err_t result = sendMessage(mac, msg);
     if (result != ESP_OK)
     {
         Serial.printf("[ESP_NOW_ERROR] Goodbye fehlgeschlagen: %d\n", result);
@@ -280,187 +1325,359 @@ void sendGoodBye(const uint8_t *mac)
 
 void initEspNow()
 {
+    // Protokoll-Task vor dem Callback, damit kein Frame ohne Konsument ankommt
+    xTaskCreatePinnedToCore(
+        espNowRxTask,
+        "EspNowRx",
+        8192, // JSON, WebSocket und NVS laufen hier
+        NULL,
+        6, // Über dem Event-Dispatcher: ACKs und Sync-Antworten zuerst
+        &espNowRxTaskHandle,
+        0); // Core 0, neben dem Netzwerk
+
+    xTaskCreatePinnedToCore(
+        espNowTxTask,
+        "EspNowTx",
+        4096,
+        NULL,
+        7, // Höchste eigene Priorität: Race-Events gehen sofort raus
+        &espNowTxTaskHandle,
+        0); // Core 0, neben dem Netzwerk
+
     esp_now_init();
     esp_now_register_recv_cb(onDataRecv);
     esp_now_register_send_cb(onDataSend);
+    addDeviceToPeer(ESPNOW_BROADCAST_MAC, true); // Dauerhaft für Discovery und Fan-out
+
+    raceEventBootId = esp_random();
+    loadJournal(); // Events, die einen Neustart während eines Ausfalls überdauert haben
+    xTaskCreatePinnedToCore(
+        raceEventRetryTask,
+        "RaceEventRetry",
+        4096,
+        NULL,
+        4, // Unter dem Event-Dispatcher
+        &raceEventRetryTaskHandle,
+        0); // Core 0, neben dem Netzwerk
 }
 
-void addDeviceToPeer(const uint8_t *mac)
+bool addDeviceToPeer(const uint8_t *mac, bool pinned)
 {
+    uint32_t now = millis();
+    uint8_t evictedMac[6];
+    bool evicted = false;
+
+    portENTER_CRITICAL(&peerMux);
+    PeerSlot *slot = findPeerSlot(mac);
+    if (slot != nullptr)
+    {
+        slot->lastUsedMs = now;
+        slot->pinned = slot->pinned || pinned;
+        portEXIT_CRITICAL(&peerMux);
+        return true;
+    }
+
+    // Freier Eintrag, sonst der am längsten ungenutzte, nicht gepinnte Peer
+    for (auto &s : peerSlots)
+    {
+        if (!s.used)
+        {
+            slot = &s;
+            break;
+        }
+    }
+    if (slot == nullptr)
+    {
+        for (auto &s : peerSlots)
+        {
+            const uint8_t *standby = getStandbyMac();
+            if (s.pinned || memcmp(s.mac, getMasterMac(), 6) == 0 || (standby != nullptr && memcmp(s.mac, standby, 6) == 0))
+                continue;
+            if (slot == nullptr || now - s.lastUsedMs > now - slot->lastUsedMs)
+                slot = &s;
+        }
+        if (slot != nullptr)
+        {
+            memcpy(evictedMac, slot->mac, 6);
+            evicted = true;
+            peerStats.evictions++;
+        }
+    }
+    if (slot == nullptr)
+    {
+        peerStats.addFailures++;
+        portEXIT_CRITICAL(&peerMux);
+        Serial.printf("[ESP_NOW_ERROR] Peer-Tabelle voll (%d gepinnt), %s nicht hinzugefügt\n",
+                      ESPNOW_PEER_MAX, macToString(mac).c_str());
+        return false;
+    }
+    slot->used = true;
+    slot->pinned = pinned;
+    memcpy(slot->mac, mac, 6);
+    slot->lastUsedMs = now;
+    portEXIT_CRITICAL(&peerMux);
+
+    if (evicted)
+    {
+        esp_now_del_peer(evictedMac);
+        Serial.printf("[ESP_NOW_DEBUG] Peer %s verdrängt für %s\n", macToString(evictedMac).c_str(), macToString(mac).c_str());
+    }
+
+    esp_err_t result = ESP_OK;
     if (!esp_now_is_peer_exist(mac))
     {
         esp_now_peer_info_t peerInfo = {};
         memcpy(peerInfo.peer_addr, mac, 6);
         peerInfo.channel = ESP_NOW_CHANNEL;
         peerInfo.encrypt = false;
-        esp_now_add_peer(&peerInfo);
+        result = esp_now_add_peer(&peerInfo);
     }
+
+    portENTER_CRITICAL(&peerMux);
+    if (result != ESP_OK)
+    {
+        slot = findPeerSlot(mac);
+        if (slot != nullptr)
+            slot->used = false;
+        peerStats.addFailures++;
+    }
+    uint32_t count = 0;
+    for (const auto &s : peerSlots)
+        count += s.used ? 1 : 0;
+    if (count > peerStats.highWater)
+        peerStats.highWater = count;
+    portEXIT_CRITICAL(&peerMux);
+
+    if (result != ESP_OK)
+        Serial.printf("[ESP_NOW_ERROR] Peer %s hinzufügen fehlgeschlagen: %d\n", macToString(mac).c_str(), result);
+    return result == ESP_OK;
 }
 
 void removeDeviceFromPeer(const uint8_t *mac)
 {
+    portENTER_CRITICAL(&peerMux);
+    PeerSlot *slot = findPeerSlot(mac);
+    if (slot != nullptr)
+        slot->used = false;
+    portEXIT_CRITICAL(&peerMux);
+
     esp_now_del_peer(mac);
 }
 
+EspNowPeerStats getEspNowPeerStats()
+{
+    portENTER_CRITICAL(&peerMux);
+    EspNowPeerStats stats = peerStats;
+    stats.count = 0;
+    stats.pinned = 0;
+    for (const auto &s : peerSlots)
+    {
+        stats.count += s.used ? 1 : 0;
+        stats.pinned += (s.used && s.pinned) ? 1 : 0;
+    }
+    portEXIT_CRITICAL(&peerMux);
+    stats.capacity = ESPNOW_PEER_MAX;
+    return stats;
+}
+
 void searchForDevices()
 {
     clearDiscoveredDevices();
     sendDiscoveryMessage();
 }
 
-void broadcastRaceEvent(Role senderRole, unsigned long eventTime)
+void broadcastRaceEvent(Role senderRole, int64_t eventTime, uint8_t channel, uint32_t sensorErrorUs)
 {
     RaceEventMessage msg;
     msg.senderRole = senderRole;
     msg.eventTime = eventTime;
-    msg.localTime = millis();
     memcpy(msg.senderMac, getMacAddress(), 6);
+    msg.channel = channel;
+    msg.sensorErrorUs = sensorErrorUs;
+    msg.masterEventTime = 0;
+    msg.translationErrorUs = UINT32_MAX;
+    memset(msg.translatedBy, 0, 6);
+    msg.flags = 0;
 
     // Sofortiges Senden ohne Verzögerung für kritische Zeiterfassung
     if (isSlave())
     {
-        // Slaves senden nur an Master - sofort
-        esp_now_send(getMasterMac(), (uint8_t *)&msg, sizeof(msg));
+        // Slaves senden nur an Master - sofort, bis zum ACK wiederholt
+        queueRaceEvent(msg);
     }
     else if (isMaster())
     {
-        // Master sendet an alle Slaves - sofort
-        for (const auto &dev : getSavedDevices())
-        {
-            if (memcmp(dev.mac, getMacAddress(), 6) != 0)
-            {
-                esp_now_send(dev.mac, (uint8_t *)&msg, sizeof(msg));
-            }
-        }
+        // Master sendet an alle Slaves - sofort, ein Frame für den Cluster
+        msg.bootId = raceEventBootId;
+        msg.eventSeq = 0; // Nur zur Info, wird nicht bestätigt
+        sendToCluster(msg, offsetof(RaceEventMessage, localTime));
     }
 }
 
 // Master-System Funktionen
-void sendMasterHeartbeat()
+void sendMasterHeartbeat(bool bypassQuiet)
 {
     if (!isMaster())
         return;
 
     MasterHeartbeatMessage msg;
-    msg.messageType = MSG_TYPE_HEARTBEAT;
     memcpy(msg.masterMac, getMacAddress(), 6);
-    msg.masterTime = millis();
     msg.sequenceNumber = millis() / 1000; // Einfache Sequenznummer
-
-    for (const auto &dev : getSavedDevices())
-    {
-        if (memcmp(dev.mac, getMacAddress(), 6) != 0) // Nicht an sich selbst senden
-        {
-            esp_now_send(dev.mac, (uint8_t *)&msg, sizeof(msg));
-        }
-    }
+    msg.stateVersion = getRaceStateVersion();
+    sendToCluster(msg, offsetof(MasterHeartbeatMessage, masterTime), bypassQuiet);
     Serial.println("[MASTER_DEBUG] Heartbeat an alle Slaves gesendet");
 }
 
-void sendTimeSyncRequest()
+void sendTimeSyncRequest(unsigned long sequenceNumber)
 {
     if (!isSlave())
         return;
 
     TimeSyncRequestMessage msg;
-    msg.messageType = MSG_TYPE_TIME_SYNC_REQUEST;
     memcpy(msg.requesterMac, getMacAddress(), 6);
-    msg.requestTime = millis();
-    msg.sequenceNumber = millis(); // Einfache Sequenznummer
+    msg.sequenceNumber = sequenceNumber;
 
-    esp_now_send(getMasterMac(), (uint8_t *)&msg, sizeof(msg));
-    Serial.printf("[SYNC_DEBUG] Zeit-Sync-Anfrage an Master gesendet: %s\n", macToString(getMasterMac()).c_str());
+    // t1 so spät wie möglich: setzt der Sende-Task direkt vor esp_now_send
+    sendMessage(getMasterMac(), msg, offsetof(TimeSyncRequestMessage, requestTime));
 }
 
-void sendTimeSyncResponse(const uint8_t *requesterMac, unsigned long originalRequestTime, unsigned long sequenceNumber)
+void sendTimeSyncResponse(const uint8_t *requesterMac, int64_t originalRequestTime, int64_t receiveTime, unsigned long sequenceNumber)
 {
     if (!isMaster())
         return;
 
     TimeSyncResponseMessage msg;
-    msg.messageType = MSG_TYPE_TIME_SYNC_RESPONSE;
     memcpy(msg.masterMac, getMacAddress(), 6);
-    msg.masterTime = millis();
     msg.originalRequestTime = originalRequestTime;
+    msg.receiveTime = receiveTime;
     msg.sequenceNumber = sequenceNumber;
 
-    esp_now_send(requesterMac, (uint8_t *)&msg, sizeof(msg));
-    Serial.printf("[SYNC_DEBUG] Zeit-Sync-Antwort an %s gesendet\n", macToString(requesterMac).c_str());
+    // t3 so spät wie möglich: setzt der Sende-Task direkt vor esp_now_send
+    sendMessage(requesterMac, msg, offsetof(TimeSyncResponseMessage, masterTime));
 }
 
-void sendRaceUpdate()
+void sendClockReport(const ClockModel &model)
 {
-    if (!isMaster())
+    if (!isSlave())
         return;
 
-    RaceUpdateMessage msg;
-    msg.messageType = MSG_TYPE_RACE_UPDATE;
-    memcpy(msg.masterMac, getMacAddress(), 6);
-    msg.raceCount = raceQueue.size() > 5 ? 5 : raceQueue.size(); // Maximal 5 Rennen
-    msg.timestamp = millis();
+    ClockReportMessage msg;
+    memcpy(msg.deviceMac, getMacAddress(), 6);
+    msg.refLocalUs = model.refLocalUs;
+    msg.offsetUs = model.offsetUs;
+    msg.skewPpm = model.skewPpm;
+    msg.skewErrorPpm = model.skewErrorPpm;
+    msg.baseErrorUs = model.baseErrorUs;
+    msg.bursts = model.bursts;
+    msg.skewValid = model.skewValid;
 
-    // Kopiere die aktuellen Race-Daten
-    int i = 0;
-    for (const auto &race : raceQueue)
+    sendMessage(getMasterMac(), msg);
+
+    // Der Standby hält die Uhrenmodelle mit, damit er nach einer Übernahme sofort umrechnen kann
+    const uint8_t *standby = getStandbyMac();
+    if (standby != nullptr && memcmp(standby, getMacAddress(), 6) != 0)
+        sendMessage(standby, msg);
+}
+
+void sendRaceDelta(RaceDeltaOp op, const RaceEntry &race, uint32_t stateVersion, const RaceEventSource *source)
+{
+    if (!isMaster())
+        return;
+
+    RaceDeltaMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.stateVersion = stateVersion;
+    msg.op = op;
+    msg.raceId = race.raceId;
+    msg.errorBound = race.errorBound;
+    if (op == RACE_DELTA_ADD)
     {
-        if (i >= 5)
-            break; // Maximal 5 Rennen
-        msg.races[i] = race;
-        i++;
+        msg.time = race.startTime;
+        memcpy(msg.device, race.startDevice, 6);
+        msg.channel = race.startChannel;
     }
-
-    // Sende die vollständigen Race-Daten an alle Slaves
-    for (const auto &dev : getSavedDevices())
+    else if (op == RACE_DELTA_FINISH)
     {
-        if (memcmp(dev.mac, getMacAddress(), 6) != 0) // Nicht an sich selbst senden
-        {
-            esp_now_send(dev.mac, (uint8_t *)&msg, sizeof(msg));
-        }
+        msg.time = race.finishTime;
+        memcpy(msg.device, race.finishDevice, 6);
+        msg.channel = race.finishChannel;
+    }
+    if (source != nullptr)
+    {
+        msg.bootId = source->bootId;
+        msg.eventSeq = source->eventSeq;
     }
-    Serial.printf("[MASTER_DEBUG] Vollständige Race-Daten an alle Slaves gesendet: %d Rennen\n", msg.raceCount);
+
+    // Verlorene Deltas erkennt der Slave an der Lücke im Stand (Snapshot-Anforderung)
+    sendToCluster(msg);
+    Serial.printf("[MASTER_DEBUG] Race-Delta %d für Rennen %u gesendet (Stand %lu)\n",
+                  op, race.raceId, (unsigned long)stateVersion);
 }
 
-void sendFullSync()
+void sendRaceSnapshot(const uint8_t *targetMac, uint32_t stateVersion)
 {
     if (!isMaster())
         return;
 
-    FullSyncMessage msg;
-    msg.messageType = MSG_TYPE_FULL_SYNC;
-    memcpy(msg.masterMac, getMacAddress(), 6);
-    msg.masterTime = millis();
-    msg.timestamp = millis();
+    // Rennen in Teilen zu RACE_SYNC_MAX, ein leerer Snapshot ist ein Teil ohne Rennen
+    RaceSnapshotMessage msg;
+    msg.stateVersion = stateVersion;
+    msg.totalCount = raceQueue.size();
+    msg.lastFinishedTime = getLastTime();
 
-    // Kopiere die aktuellen Race-Daten
-    int i = 0;
-    for (const auto &race : raceQueue)
+    uint16_t offset = 0;
+    do
     {
-        if (i >= 5)
-            break; // Maximal 5 Rennen
-        msg.races[i] = race;
-        i++;
-    }
-    msg.raceCount = i;
+        msg.offset = offset;
+        msg.raceCount = 0;
+        for (uint16_t i = offset; i < raceQueue.size() && msg.raceCount < RACE_SYNC_MAX; i++)
+            msg.races[msg.raceCount++] = raceQueue[i];
+        offset += msg.raceCount;
 
-    // Finde die letzte beendete Zeit
-    msg.lastFinishedTime = 0;
-    for (auto it = raceQueue.rbegin(); it != raceQueue.rend(); ++it)
-    {
-        if (it->isFinished)
-        {
-            msg.lastFinishedTime = it->duration;
-            break;
-        }
-    }
+        // Snapshots schließen Lücken in Kopien (Standby!), das Ruhefenster hält sie nicht auf
+        if (targetMac != nullptr)
+            sendMessage(targetMac, msg, -1, true);
+        else
+            sendToCluster(msg, -1, true);
+    } while (offset < raceQueue.size());
 
-    // Sende vollständige Sync-Daten an alle Slaves
-    for (const auto &dev : getSavedDevices())
-    {
-        if (memcmp(dev.mac, getMacAddress(), 6) != 0) // Nicht an sich selbst senden
-        {
-            esp_now_send(dev.mac, (uint8_t *)&msg, sizeof(msg));
-        }
-    }
-    Serial.printf("[MASTER_DEBUG] Full-Sync an alle Slaves gesendet: %d Rennen, letzte Zeit: %lu ms\n",
-                  msg.raceCount, msg.lastFinishedTime);
-}
\ No newline at end of file
+    Serial.printf("[MASTER_DEBUG] Race-Snapshot gesendet: %d Rennen (Stand %lu)\n",
+                  (int)raceQueue.size(), (unsigned long)stateVersion);
+}
+
+void sendSnapshotRequest(uint32_t haveVersion)
+{
+    if (!isSlave())
+        return;
+
+    SnapshotRequestMessage msg;
+    msg.haveVersion = haveVersion;
+    sendMessage(getMasterMac(), msg, -1, true);
+}
+
+void sendLease(uint32_t term, uint16_t leaseMs, const uint8_t *standbyMac, uint32_t stateVersion)
+{
+    if (!isMaster())
+        return;
+
+    LeaseMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    memcpy(msg.masterMac, getMacAddress(), 6);
+    msg.term = term;
+    msg.leaseMs = leaseMs;
+    if (standbyMac != nullptr)
+        memcpy(msg.standbyMac, standbyMac, 6);
+    msg.stateVersion = stateVersion;
+    sendToCluster(msg);
+}
+
+void sendStandbyAck(uint32_t term, uint32_t stateVersion)
+{
+    if (!isSlave())
+        return;
+
+    StandbyAckMessage msg;
+    msg.term = term;
+    msg.stateVersion = stateVersion;
+    sendMessage(getMasterMac(), msg);
+}
@@ -5,96 +5,439 @@
 #include <deviceInfo.h>
 #include <esp_now.h>
 #include <role.h>
+#include <clockSync.h>
 
-// Forward declarations
-struct RaceEntry
-{
-    unsigned long startTime;
-    unsigned long startTimeLocal;  // Lokale Zeit des Start-Geräts
-    uint8_t startDevice[6];        // MAC des Start-Geräts
-    bool isFinished;               // Wurde das Rennen beendet?
-    unsigned long finishTime;      // Ziel-Zeit (nur wenn isFinished=true)
-    unsigned long finishTimeLocal; // Lokale Zeit des Ziel-Geräts
-    uint8_t finishDevice[6];       // MAC des Ziel-Geräts
-    unsigned long duration;        // Berechnete Dauer in ms
-};
+// Drahtformat: Jeder Frame beginnt mit WireHeader, alle Strukturen sind gepackt
+// (keine Compiler-Abhängigkeit beim Padding). Inkompatible Änderungen erhöhen
+// WIRE_VERSION, Frames fremder Versionen werden verworfen.
+#define WIRE_MAGIC 0x4C53 // "LS"
+#define WIRE_VERSION 6
+#define ESPNOW_MAX_FRAME 250
+
+// Mehrere Anlagen auf demselben Kanal werden über die Cluster-ID getrennt:
+// Empfänger verwerfen jeden Frame mit fremder ID, auch Broadcasts.
+#ifndef DEFAULT_CLUSTER_ID
+#define DEFAULT_CLUSTER_ID 1
+#endif
+
+extern const uint8_t ESPNOW_BROADCAST_MAC[6];
 
-// Message-Typen
+// Message-Typen (Index in die Dispatch-Tabelle)
 #define MSG_TYPE_HEARTBEAT 1
 #define MSG_TYPE_TIME_SYNC_REQUEST 2
 #define MSG_TYPE_TIME_SYNC_RESPONSE 3
-#define MSG_TYPE_RACE_UPDATE 4
-#define MSG_TYPE_FULL_SYNC 5
+#define MSG_TYPE_RACE_DELTA 4
+#define MSG_TYPE_RACE_SNAPSHOT 5
 #define MSG_TYPE_SAVE_DEVICE 6
+#define MSG_TYPE_RACE_EVENT 7
+#define MSG_TYPE_CLOCK_REPORT 8
+#define MSG_TYPE_DISCOVERY 9
+#define MSG_TYPE_IDENTITY 10
+#define MSG_TYPE_RACE_EVENT_ACK 11
+#define MSG_TYPE_SNAPSHOT_REQUEST 12
+#define MSG_TYPE_LEASE 13
+#define MSG_TYPE_STANDBY_ACK 14
+#define MSG_TYPE_COUNT 15
+
+struct __attribute__((packed)) WireHeader
+{
+    uint16_t magic;    // WIRE_MAGIC
+    uint8_t version;   // WIRE_VERSION
+    uint8_t type;      // MSG_TYPE_*
+    uint16_t sequence; // Fortlaufend pro Sender
+    uint8_t length;    // Gesamtlänge des Frames inklusive Header
+    uint16_t cluster;  // Cluster-ID des Senders
+};
+
+// Alle Zeiten in µs (64 Bit), gerundet wird erst bei der Ausgabe
+struct __attribute__((packed)) RaceEntry
+{
+    int64_t startTime;       // Start-Zeit (µs)
+    int64_t finishTime;      // Ziel-Zeit (nur wenn isFinished=true, µs)
+    int64_t duration;        // Berechnete Dauer in µs
+    uint8_t startDevice[6];  // MAC des Start-Geräts
+    uint8_t finishDevice[6]; // MAC des Ziel-Geräts
+    bool isFinished;         // Wurde das Rennen beendet?
+    uint8_t startChannel;    // Sensor-Kanal am Start
+    uint8_t finishChannel;   // Sensor-Kanal im Ziel
+    uint8_t errorBound;      // Fehlergrenze in RACE_ERROR_UNIT_US, aufgerundet (RACE_ERROR_UNKNOWN = unbekannt)
+    uint16_t raceId;         // Vom Master vergeben, Schlüssel für Deltas
+};
+
+// Die Fehlergrenze ist ein Byte, damit 5 Rennen in einen Snapshot-Frame passen
+#define RACE_ERROR_UNIT_US 250
+#define RACE_ERROR_UNKNOWN 255
+#define SENSOR_ERROR_UNKNOWN UINT32_MAX // sensorErrorUs: Auslösung ohne vorheriges Sample
+
+// Maximale Anzahl Rennen pro Snapshot-Frame (ESP-NOW erlaubt 250 Bytes),
+// größere Listen gehen in mehreren Frames
+#define RACE_SYNC_MAX 5
+
+// Slaves fordern höchstens so oft einen Snapshot an
+#define RACE_SNAPSHOT_REQUEST_MIN_MS 1000
 
 #ifndef ESP_NOW_CHANNEL
 #define ESP_NOW_CHANNEL 8
 #endif
 
-struct SaveDeviceMessage
+// Broadcast-Suche, Empfänger antworten mit IdentityMessage
+struct __attribute__((packed)) DiscoveryMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_DISCOVERY;
+    WireHeader header;
+};
+
+// Identität eines Geräts (Antwort auf Discovery, Rollenänderung, Goodbye)
+struct __attribute__((packed)) IdentityMessage
 {
-    uint8_t messageType; // MSG_TYPE_SAVE_DEVICE = 6
+    static constexpr uint8_t TYPE = MSG_TYPE_IDENTITY;
+    WireHeader header;
+    uint8_t mac[6];
+    Role role;
+};
+
+struct __attribute__((packed)) SaveDeviceMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_SAVE_DEVICE;
+    WireHeader header;
     uint8_t targetMac[6];
     Role targetRole;
     uint8_t senderMac[6];
     Role senderRole;
 };
 
-struct RaceEventMessage
+struct __attribute__((packed)) RaceEventMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_RACE_EVENT;
+    WireHeader header;
+    Role senderRole;        // ROLE_START oder ROLE_ZIEL
+    int64_t eventTime;      // Sensor-Zeitstempel beim Auslösen (µs)
+    int64_t localTime;      // Lokale Sendezeit des Geräts (µs)
+    uint8_t senderMac[6];   // MAC des sendenden Geräts
+    uint8_t channel;        // Sensor-Kanal des Senders
+    uint32_t sensorErrorUs; // Abtastbedingte Unsicherheit von eventTime (µs), SENSOR_ERROR_UNKNOWN = unbekannt
+    uint32_t bootId;        // Zufällig pro Start, trennt Event-Nummern verschiedener Starts
+    uint16_t eventSeq;      // Fortlaufende Event-Nummer des Senders (für ACK und Duplikate)
+    // Übersetzung des Senders beim Auslösen, gilt nur für den Master translatedBy
+    int64_t masterEventTime;     // eventTime in Master-Zeit (µs)
+    uint32_t translationErrorUs; // Fehlergrenze, UINT32_MAX = keine Übersetzung
+    uint8_t translatedBy[6];     // Master, auf dessen Uhr übersetzt wurde
+    uint8_t flags;               // RACE_EVENT_*
+};
+
+#define RACE_EVENT_PREVIOUS_BOOT 0x01 // Aus dem Journal eines früheren Starts, localTime ohne Bezug
+#define RACE_EVENT_FORWARDED 0x02     // Von einem zurückgetretenen Master weitergegeben, gilt nur die Übersetzung
+
+// Bestätigung des Masters für ein RaceEvent, auch für Duplikate
+struct __attribute__((packed)) RaceEventAckMessage
 {
-    Role senderRole;         // ROLE_START oder ROLE_ZIEL
-    unsigned long eventTime; // millis() beim Auslösen
-    unsigned long localTime; // Lokale Zeit des sendenden Geräts
-    uint8_t senderMac[6];    // MAC des sendenden Geräts
+    static constexpr uint8_t TYPE = MSG_TYPE_RACE_EVENT_ACK;
+    WireHeader header;
+    uint8_t masterMac[6];
+    uint32_t bootId;
+    uint16_t eventSeq;
 };
 
-struct MasterHeartbeatMessage
+struct __attribute__((packed)) MasterHeartbeatMessage
 {
-    uint8_t messageType; // 1 = Heartbeat
+    static constexpr uint8_t TYPE = MSG_TYPE_HEARTBEAT;
+    WireHeader header;
     uint8_t masterMac[6];
-    unsigned long masterTime;
-    unsigned long sequenceNumber;
+    int64_t masterTime; // µs
+    uint32_t sequenceNumber;
+    uint32_t stateVersion; // Stand der Race-Liste, Slaves erkennen daran verpasste Deltas
 };
 
-struct TimeSyncRequestMessage
+struct __attribute__((packed)) TimeSyncRequestMessage
 {
-    uint8_t messageType; // 2 = TimeSyncRequest
+    static constexpr uint8_t TYPE = MSG_TYPE_TIME_SYNC_REQUEST;
+    WireHeader header;
     uint8_t requesterMac[6];
-    unsigned long requestTime;
-    unsigned long sequenceNumber;
+    int64_t requestTime;     // t1: Sendezeit des Slaves (µs)
+    uint32_t sequenceNumber; // Burst-Kennung
 };
 
-struct TimeSyncResponseMessage
+struct __attribute__((packed)) TimeSyncResponseMessage
 {
-    uint8_t messageType; // 3 = TimeSyncResponse
+    static constexpr uint8_t TYPE = MSG_TYPE_TIME_SYNC_RESPONSE;
+    WireHeader header;
     uint8_t masterMac[6];
-    unsigned long masterTime;
-    unsigned long originalRequestTime;
-    unsigned long sequenceNumber;
+    int64_t masterTime;          // t3: Sendezeit des Masters (µs)
+    int64_t originalRequestTime; // t1: aus der Anfrage zurückgespiegelt (µs)
+    int64_t receiveTime;         // t2: Empfang der Anfrage beim Master (µs)
+    uint32_t sequenceNumber;     // Burst-Kennung aus der Anfrage
 };
 
-struct RaceUpdateMessage
+// Uhrenmodell eines Slaves gegenüber dem Master, nach jedem Sync-Burst an den Master
+struct __attribute__((packed)) ClockReportMessage
 {
-    uint8_t messageType; // 4 = RaceUpdate
-    uint8_t masterMac[6];
-    int raceCount;
-    RaceEntry races[5]; // Maximal 5 aktive Rennen gleichzeitig
-    unsigned long timestamp;
+    static constexpr uint8_t TYPE = MSG_TYPE_CLOCK_REPORT;
+    WireHeader header;
+    uint8_t deviceMac[6];
+    int64_t refLocalUs;  // Bezugspunkt in Slave-Zeit (µs)
+    int64_t offsetUs;    // Master - Slave am Bezugspunkt (µs)
+    double skewPpm;
+    double skewErrorPpm;
+    int64_t baseErrorUs; // Fehlergrenze am Bezugspunkt (µs)
+    uint32_t bursts;
+    bool skewValid;
+};
+
+// Replikation der Race-Liste: Jede Änderung erhöht stateVersion um 1 und geht
+// als kleines Delta an alle Slaves. Bei einer Lücke fordert der Slave einen
+// Snapshot an. Absender ist immer der Master (MAC aus dem Empfangs-Callback).
+enum RaceDeltaOp : uint8_t
+{
+    RACE_DELTA_ADD,    // Neues Rennen: time = Start
+    RACE_DELTA_FINISH, // Rennen beendet: time = Ziel
+    RACE_DELTA_REMOVE  // Rennen entfernt, nur raceId
+};
+
+struct __attribute__((packed)) RaceDeltaMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_RACE_DELTA;
+    WireHeader header;
+    uint32_t stateVersion; // Stand nach Anwenden des Deltas
+    uint8_t op;            // RaceDeltaOp
+    uint16_t raceId;
+    int64_t time;       // Start- bzw. Zielzeit in Master-Zeit (µs)
+    uint8_t device[6];  // Start- bzw. Ziel-Gerät
+    uint8_t channel;    // Sensor-Kanal am Gerät
+    uint8_t errorBound; // Wie RaceEntry.errorBound
+    uint32_t bootId;    // Auslösendes Race-Event von device (eventSeq 0 = lokal beim Master),
+    uint16_t eventSeq;  // der Standby übernimmt damit das Duplikat-Fenster
 };
 
-struct FullSyncMessage
+// Ein Teil des Snapshots; die Teile kommen in Reihenfolge (offset aufsteigend)
+struct __attribute__((packed)) RaceSnapshotMessage
 {
-    uint8_t messageType; // 5 = FullSync
+    static constexpr uint8_t TYPE = MSG_TYPE_RACE_SNAPSHOT;
+    WireHeader header;
+    uint32_t stateVersion;
+    uint16_t totalCount;            // Rennen im gesamten Snapshot
+    uint16_t offset;                // Index des ersten Rennens in diesem Teil
+    uint8_t raceCount;              // Rennen in diesem Teil
+    RaceEntry races[RACE_SYNC_MAX];
+    int64_t lastFinishedTime;       // Letzte beendete Dauer (µs)
+};
+
+struct __attribute__((packed)) SnapshotRequestMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_SNAPSHOT_REQUEST;
+    WireHeader header;
+    uint32_t haveVersion; // Stand des Slaves (nur zur Diagnose)
+};
+
+// Leader-Lease: Der Master erneuert sie alle LEASE_RENEW_MS per Broadcast. Läuft
+// sie ab, übernimmt der benannte Standby mit term + 1. Höherer term gewinnt,
+// bei gleichem term die niedrigere MAC.
+struct __attribute__((packed)) LeaseMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_LEASE;
+    WireHeader header;
     uint8_t masterMac[6];
-    unsigned long masterTime;
-    int raceCount;
-    RaceEntry races[5];             // Aktuelle Rennen
-    unsigned long lastFinishedTime; // Letzte beendete Zeit
-    unsigned long timestamp;
+    uint32_t term;
+    uint16_t leaseMs;      // Gültigkeit ab Empfang
+    uint8_t standbyMac[6]; // Nachfolger, 00:00:00:00:00:00 = keiner
+    uint32_t stateVersion; // Stand der Race-Liste
+};
+
+// Standby an Master: lebt und hält die Race-Liste auf diesem Stand
+struct __attribute__((packed)) StandbyAckMessage
+{
+    static constexpr uint8_t TYPE = MSG_TYPE_STANDBY_ACK;
+    WireHeader header;
+    uint32_t term;
+    uint32_t stateVersion;
+};
+
+static_assert(sizeof(WireHeader) == 9, "WireHeader ist Teil des Drahtformats");
+static_assert(sizeof(RaceEntry) == 42, "RaceEntry ist Teil des Drahtformats");
+static_assert(sizeof(Role) == 1, "Role ist Teil des Drahtformats");
+static_assert(sizeof(IdentityMessage) == 16, "IdentityMessage ist Teil des Drahtformats");
+static_assert(sizeof(SaveDeviceMessage) == 23, "SaveDeviceMessage ist Teil des Drahtformats");
+static_assert(sizeof(RaceEventMessage) == 62, "RaceEventMessage ist Teil des Drahtformats");
+static_assert(sizeof(IdentityMessage) <= ESPNOW_MAX_FRAME, "IdentityMessage zu groß für ESP-NOW");
+static_assert(sizeof(SaveDeviceMessage) <= ESPNOW_MAX_FRAME, "SaveDeviceMessage zu groß für ESP-NOW");
+static_assert(sizeof(RaceEventMessage) <= ESPNOW_MAX_FRAME, "RaceEventMessage zu groß für ESP-NOW");
+static_assert(sizeof(RaceEventAckMessage) <= ESPNOW_MAX_FRAME, "RaceEventAckMessage zu groß für ESP-NOW");
+static_assert(sizeof(MasterHeartbeatMessage) <= ESPNOW_MAX_FRAME, "MasterHeartbeatMessage zu groß für ESP-NOW");
+static_assert(sizeof(TimeSyncRequestMessage) <= ESPNOW_MAX_FRAME, "TimeSyncRequestMessage zu groß für ESP-NOW");
+static_assert(sizeof(TimeSyncResponseMessage) <= ESPNOW_MAX_FRAME, "TimeSyncResponseMessage zu groß für ESP-NOW");
+static_assert(sizeof(ClockReportMessage) <= ESPNOW_MAX_FRAME, "ClockReportMessage zu groß für ESP-NOW");
+static_assert(sizeof(RaceDeltaMessage) <= ESPNOW_MAX_FRAME, "RaceDeltaMessage zu groß für ESP-NOW");
+static_assert(sizeof(RaceSnapshotMessage) <= ESPNOW_MAX_FRAME, "RaceSnapshotMessage zu groß für ESP-NOW");
+static_assert(sizeof(SnapshotRequestMessage) <= ESPNOW_MAX_FRAME, "SnapshotRequestMessage zu groß für ESP-NOW");
+static_assert(sizeof(LeaseMessage) <= ESPNOW_MAX_FRAME, "LeaseMessage zu groß für ESP-NOW");
+static_assert(sizeof(StandbyAckMessage) <= ESPNOW_MAX_FRAME, "StandbyAckMessage zu groß für ESP-NOW");
+
+// Frames zwischen WiFi-Callback und Protokoll-Task (Zweierpotenz)
+#ifndef ESPNOW_RX_QUEUE_SIZE
+#define ESPNOW_RX_QUEUE_SIZE 16
+#endif
+
+// Zuverlässige Zustellung von Race-Events (Slave -> Master): ACK + Wiederholung.
+// Unbestätigte Events liegen im Journal, bis der Master sie bestätigt hat.
+#ifndef RACE_JOURNAL_SIZE
+#define RACE_JOURNAL_SIZE 32 // Unbestätigte Events, danach wird das älteste verdrängt
+#endif
+#define RACE_JOURNAL_DRAIN_BURST 4   // Nachgelieferte Events pro Durchlauf
+#define RACE_JOURNAL_POLL_MS 100     // Abfrage der Erreichbarkeit, solange Events warten
+#define RACE_EVENT_RETRY_MS 20       // Erste Wartezeit auf das ACK, danach verdoppelt
+#define RACE_EVENT_RETRY_MAX_MS 1000 // Obergrenze der Wartezeit
+#define RACE_EVENT_MAX_ATTEMPTS 8    // Danach als zwischengespeichert geführt, Versuche laufen weiter
+#define RACE_EVENT_DEDUPE_WINDOW RACE_JOURNAL_SIZE // Zuletzt gesehene Events pro Sender
+#define RACE_LINK_PEERS_MAX 8
+
+// Zähler pro Gegenstelle; Sender-Seite (Slave) und Empfänger-Seite (Master)
+struct RaceLinkStats
+{
+    uint8_t mac[6];
+    uint32_t sent;       // Neue Events an diese Gegenstelle
+    uint32_t retries;    // Wiederholungen
+    uint32_t acked;      // Bestätigte Events
+    uint32_t lost;       // Im vollen Journal verdrängt
+    uint32_t received;   // Neue Events von dieser Gegenstelle
+    uint32_t duplicates; // Erneut empfangene, bereits verarbeitete Events
+    uint32_t stale;      // Aus früherem Start ohne gültige Übersetzung verworfen
+};
+
+// Journal des Slaves (Store-and-Forward bei Master-Ausfall)
+struct RaceJournalStats
+{
+    uint8_t depth;      // Aktuell unbestätigte Events
+    uint8_t capacity;   // RACE_JOURNAL_SIZE
+    uint8_t persisted;  // Davon im NVS
+    uint8_t restored;   // Beim Start aus dem NVS geladen
+    uint32_t journaled; // Events, die auf den Master warten mussten
+    uint32_t drained;   // Davon später bestätigt
+    uint32_t overflows; // Im vollen Journal verdrängt
+    uint32_t persists;  // Schreibvorgänge ins NVS
+    uint32_t stale;     // Eigene Events ohne gültige Zeitbasis verworfen
+};
+
+// NVS-Abbild des Journals, nur die belegten Einträge werden geschrieben
+struct __attribute__((packed)) RaceJournalBlob
+{
+    uint8_t wireVersion; // Events fremder Versionen werden beim Laden verworfen
+    uint8_t count;
+    RaceEventMessage events[RACE_JOURNAL_SIZE];
+};
+
+// Peer-Tabelle der IDF (ESP_NOW_MAX_TOTAL_PEER_NUM, unverschlüsselt)
+#ifndef ESPNOW_PEER_MAX
+#define ESPNOW_PEER_MAX 20
+#endif
+
+struct EspNowPeerStats
+{
+    uint32_t count;       // Belegte Einträge
+    uint32_t capacity;    // ESPNOW_PEER_MAX
+    uint32_t pinned;      // Gespeicherte Geräte und Broadcast, nie verdrängt
+    uint32_t highWater;   // Höchste Belegung seit Start
+    uint32_t evictions;   // Wegen Platzmangel entfernte Peers
+    uint32_t addFailures; // Kein Platz (alles gepinnt) oder IDF-Fehler
+};
+
+// Sende-Scheduler: eine Queue pro Klasse, die höchste nicht leere Klasse
+// sendet zuerst. Pro Peer sind höchstens ESPNOW_TX_INFLIGHT_PER_PEER Frames
+// ohne onDataSend unterwegs.
+enum TxClass : uint8_t
+{
+    TX_CLASS_RACE,      // Race-Events, ACKs, Race-Deltas
+    TX_CLASS_SYNC,      // Zeit-Sync, Uhrenberichte, Lease
+    TX_CLASS_STATE,     // Heartbeat, Snapshots
+    TX_CLASS_DISCOVERY, // Discovery, Identität, Rollenwechsel
+    TX_CLASS_COUNT
+};
+
+#define ESPNOW_TX_QUEUE_RACE 8
+#define ESPNOW_TX_QUEUE_SYNC 8
+#define ESPNOW_TX_QUEUE_STATE 16
+#define ESPNOW_TX_QUEUE_DISCOVERY 8
+#define ESPNOW_TX_INFLIGHT_PER_PEER 2
+#define ESPNOW_TX_INFLIGHT_TIMEOUT_MS 100 // Fehlendes onDataSend gibt den Peer wieder frei
+#define ESPNOW_TX_RETRY_MS 5              // Wartezeit nach ESP_ERR_ESPNOW_NO_MEM
+
+// Ruhefenster um einen erwarteten Zieleinlauf: Frames der Klassen state und
+// discovery bleiben in der Queue, höchstens ESPNOW_QUIET_MAX_MS am Stück.
+// Frames mit bypassQuiet (Pflicht-Heartbeat, Snapshots) gehen trotzdem raus.
+#ifndef ESPNOW_QUIET_MAX_MS
+#define ESPNOW_QUIET_MAX_MS 8000
+#endif
+
+struct EspNowTxClassStats
+{
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t coalesced; // Durch neueren Stand derselben Nachricht ersetzt
+    uint32_t dropped;   // Queue voll
+    uint32_t noMemRetries;
+    uint32_t depth;
+    uint32_t highWater;
+    int64_t latencySumUs; // Einreihen bis esp_now_send
+    int64_t maxLatencyUs;
+};
+
+// Empfangs- und Sendezeiten des Funks (µs)
+struct EspNowTimingStats
+{
+    uint32_t rxFrames;
+    int64_t rxHandlingSumUs; // Zeitstempel im Callback bis Ende der Verarbeitung
+    int64_t maxRxHandlingUs;
+    uint32_t rxRejected;       // Falsche Kennung/Version/Länge oder unbekannter Typ
+    uint32_t rxForeignCluster; // Gültiger Frame einer anderen Anlage
+    uint32_t rxQueueDepth;
+    uint32_t rxQueueHighWater;
+    uint32_t rxDropped; // Queue voll, Frame im Callback verworfen
+    uint32_t txFrames;
+    uint32_t txBroadcasts; // Davon Fan-out-Frames an den ganzen Cluster
+    uint32_t txErrors;  // esp_now_send abgelehnt
+    uint32_t txFailed;  // Keine Bestätigung vom Empfänger
+    uint32_t txCompleted;
+    int64_t txCompleteSumUs; // esp_now_send bis onDataSend
+    int64_t maxTxCompleteUs;
+    uint32_t quietWindows; // Begonnene Ruhefenster
+    bool quiet;            // Ruhefenster gerade aktiv
 };
 
 void initEspNow();
 
+// Empfangs-Callback: nimmt als Erstes den Zeitstempel und legt den Frame in die
+// Queue; handleEspNowFrame läuft danach im Protokoll-Task (EspNowRx, Core 0)
+void onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len);
+void handleEspNowFrame(const uint8_t *mac, const uint8_t *incomingData, int len, int64_t rxTimeUs);
+
+// Alle Frames laufen hierüber in den Sende-Scheduler (EspNowTx-Task).
+// stampOffset >= 0: an dieser Stelle setzt der Task unmittelbar vor
+// esp_now_send den aktuellen getTimeUs()-Wert ein (int64_t).
+// Liefert ESP_ERR_ESPNOW_NO_MEM, wenn die Queue der Klasse voll ist.
+esp_err_t espNowSend(const uint8_t *mac, const uint8_t *data, size_t len, int stampOffset = -1, bool bypassQuiet = false);
+void fillWireHeader(WireHeader &header, uint8_t type, size_t length);
+
+// Header ausfüllen und einreihen; Sendezeitstempel per offsetof(T, feld)
+template <typename T>
+esp_err_t sendMessage(const uint8_t *mac, T &msg, int stampOffset = -1, bool bypassQuiet = false)
+{
+    fillWireHeader(msg.header, T::TYPE, sizeof(T));
+    return espNowSend(mac, (const uint8_t *)&msg, sizeof(T), stampOffset, bypassQuiet);
+}
+
+// Ein Broadcast-Frame an alle Geräte des Clusters statt Unicast pro Peer.
+// Ohne MAC-ACK: nur für Nachrichten, deren Verlust der Empfänger selbst erkennt
+// (Heartbeat, Race-Deltas mit Stand). Zuverlässige Nachrichten bleiben Unicast.
+template <typename T>
+esp_err_t sendToCluster(T &msg, int stampOffset = -1, bool bypassQuiet = false)
+{
+    return sendMessage(ESPNOW_BROADCAST_MAC, msg, stampOffset, bypassQuiet);
+}
+EspNowTimingStats getEspNowTimingStats();
+void getEspNowTxClassStats(EspNowTxClassStats *out); // TX_CLASS_COUNT Einträge
+const char *txClassToString(uint8_t txClass);
+
+// Ruhefenster ein/aus (Master-Task); race und sync senden weiter
+void setEspNowQuiet(bool quiet);
+
 void sendIdentity(const uint8_t *dest);
 
 void sendDiscoveryMessage();
@@ -107,18 +450,52 @@ bool tellOtherDeviceToChangeHisRole(const uint8_t *targetMac, Role newRole);
 
 void searchForDevices();
 
-void addDeviceToPeer(const uint8_t *mac);
+// Peer-Verwaltung: espNowSend legt fehlende Peers selbst an. Gepinnte Peers
+// (gespeicherte Geräte) bleiben, sonst wird der am längsten ungenutzte verdrängt;
+// Master und Standby werden nie verdrängt.
+bool addDeviceToPeer(const uint8_t *mac, bool pinned = false);
 
 void removeDeviceFromPeer(const uint8_t *mac);
+EspNowPeerStats getEspNowPeerStats();
 
 // Sende RaceEventMessage an alle bekannten Geräte
-void broadcastRaceEvent(Role senderRole, unsigned long eventTime);
+// Slaves: Zustellung an den Master mit ACK, Wiederholung läuft im RaceEventRetry-Task
+void broadcastRaceEvent(Role senderRole, int64_t eventTime, uint8_t channel, uint32_t sensorErrorUs);
+int getRaceLinkStats(RaceLinkStats *out, int maxCount);
+RaceJournalStats getRaceJournalStats();
+
+// Auslösendes Race-Event eines Rennens (Duplikat-Erkennung über einen Master-Wechsel)
+struct RaceEventSource
+{
+    uint32_t bootId;
+    uint16_t eventSeq;       // 0 = lokal beim Master ausgelöst, keine Duplikat-Erkennung
+    bool hasTranslation;     // Sender hat eventTime in unsere Master-Zeit übersetzt
+    int64_t masterTime;      // Übersetzte Event-Zeit (µs)
+    int64_t masterErrorUs;   // Fehlergrenze der Übersetzung (µs)
+    bool previousBoot;       // Event aus früherem Start des Senders
+};
+
+// Standby: Event als bereits verarbeitet merken, ohne Zähler (aus Race-Deltas)
+void rememberRaceEvent(const uint8_t *senderMac, uint32_t bootId, uint16_t eventSeq);
+
+// Zurückgetretener Master: als Master verarbeitetes Event über das Journal an den neuen
+// Master geben. eventTime liegt in der eigenen Zeit, errorUs ist deren Fehlergrenze (-1 = unbekannt).
+// eventSeq 0 (selbst ausgelöst) bekommt eine eigene Kennung. false ohne Uhrenmodell des Masters.
+bool forwardRaceEvent(Role role, const uint8_t *device, uint32_t bootId, uint16_t eventSeq, int64_t eventTime,
+                      int64_t errorUs, uint8_t channel, uint32_t sensorErrorUs);
 
 // Master-System Funktionen
-void sendMasterHeartbeat();
-void sendTimeSyncRequest();
-void sendTimeSyncResponse(const uint8_t *requesterMac, unsigned long originalRequestTime, unsigned long sequenceNumber);
-void sendRaceUpdate();
-void sendFullSync();
+// bypassQuiet: Pflicht-Heartbeat nach HEARTBEAT_MAX_GAP_MS, am Ruhefenster vorbei
+void sendMasterHeartbeat(bool bypassQuiet = false);
+void sendTimeSyncRequest(unsigned long sequenceNumber);
+void sendTimeSyncResponse(const uint8_t *requesterMac, int64_t originalRequestTime, int64_t receiveTime, unsigned long sequenceNumber);
+void sendClockReport(const ClockModel &model);
+// Race-Replikation: Delta an alle Slaves, Snapshot an einen Slave (nullptr = alle)
+void sendRaceDelta(RaceDeltaOp op, const RaceEntry &race, uint32_t stateVersion, const RaceEventSource *source = nullptr);
+void sendRaceSnapshot(const uint8_t *targetMac, uint32_t stateVersion);
+void sendSnapshotRequest(uint32_t haveVersion);
+// Leader-Lease (Master) und Lebenszeichen des Standbys
+void sendLease(uint32_t term, uint16_t leaseMs, const uint8_t *standbyMac, uint32_t stateVersion);
+void sendStandbyAck(uint32_t term, uint32_t stateVersion);
 
 #endif
\ No newline at end of file
@@ -59,15 +59,9 @@ void setup()
   // Master-Task starten
   initMasterTask();
 
-  // Reduzierte Verzögerung für Netzwerk-Stabilisierung
+  // Reduzierte Verzögerung für Netzwerk-Stabilisierung; den ersten Sync-Burst startet der Master-Task
   delay(1000); // Reduziert von 3000ms auf 1000ms
 
-  // Zeit-Synchronisation starten (falls Slave)
-  if (isSlave())
-  {
-    syncTimeWithMaster();
-  }
-
   setupOTA();
 
   Serial.printf("[MASTER_DEBUG] Setup abgeschlossen - Status: %s\n", masterStatusToString(getMasterStatus()).c_str());
@@ -1,55 +1,129 @@
 #include <task.h>
+#include <masterTask.h>
 
 TaskHandle_t masterTaskHandle = NULL;
 
+static RadioPolicyStats policyStats;
+
+RadioPolicyStats getRadioPolicyStats()
+{
+    return policyStats;
+}
+
 void masterTask(void *pvParameters)
 {
     unsigned long lastHeartbeat = 0;
-    unsigned long lastMasterCheck = 0;
     unsigned long lastTimeSync = 0;
+    uint8_t syncedMaster[6] = {0}; // Master des letzten Sync-Bursts
     unsigned long lastRaceCleanup = 0;
-    unsigned long lastFullSync = 0;
+
+    // Während eines Rennens zurückgestellt, nach dem letzten Rennen nachgeholt
+    bool heartbeatPending = false;
+    bool syncPending = false;
+    bool cleanupPending = false;
+    bool prewarmDone = false;
 
     for (;;)
     {
         unsigned long now = millis();
 
-        // Heartbeat senden (Master) - reduziert für weniger Störungen
-        if (isMaster() && (now - lastHeartbeat > 10000)) // 10 Sekunden statt 5
+        // Funk-Politik: Solange Rennen laufen, gehört die Luft dem Zieleinlauf
+        bool raceActive = getLaufCount() > 0;
+        int64_t remainingUs = 0;
+        bool expected = raceActive && getNextExpectedFinishUs(remainingUs, (int64_t)RACE_QUIET_TAIL_MS * 1000);
+        bool quiet = expected && remainingUs <= (int64_t)RACE_QUIET_LEAD_MS * 1000;
+
+        if (quiet != policyStats.quiet)
         {
-            sendHeartbeat();
-            lastHeartbeat = now;
+            setEspNowQuiet(quiet);
+            if (!quiet)
+                prewarmDone = false; // Nächstes erwartetes Ziel bekommt wieder einen Burst
         }
 
-        // Full-Sync senden (Master) - reduziert für weniger Störungen
-        if (isMaster() && (now - lastFullSync > 15000)) // 15 Sekunden statt 10
+        if (!raceActive && policyStats.raceActive)
         {
-            sendFullSync();
-            lastFullSync = now;
+            // Letztes Rennen beendet: Stand verteilen, Uhr und Liste aufholen
+            Serial.println("[MASTER_DEBUG] Keine laufenden Rennen mehr, hole zurückgestellte Aufgaben nach");
+            policyStats.catchUps++;
+            heartbeatPending = true; // Slaves erkennen am Stand verpasste Deltas
+            prewarmDone = false;
         }
+        policyStats.raceActive = raceActive;
+        policyStats.quiet = quiet;
 
-        // Master-Online-Check (Slave)
-        if (now - lastMasterCheck > 10000)
+        // Heartbeat senden (Master); im Ruhefenster verschoben, der Timeout der Slaves ist länger
+        if (isMaster() && (heartbeatPending || now - lastHeartbeat > 10000))
         {
-            checkMasterOnline();
-            lastMasterCheck = now;
+            if (quiet && now - lastHeartbeat < HEARTBEAT_MAX_GAP_MS)
+            {
+                if (!heartbeatPending)
+                    policyStats.deferredHeartbeats++;
+                heartbeatPending = true;
+            }
+            else
+            {
+                // Nach HEARTBEAT_MAX_GAP_MS am Ruhefenster vorbei, sonst hielte es der TX-Task weiter zurück
+                sendHeartbeat(quiet);
+                lastHeartbeat = now;
+                heartbeatPending = false;
+            }
         }
 
-        // Zeit-Synchronisation (Slave) - reduziert für weniger Störungen
-        if (isSlave() && (now - lastTimeSync > 60000)) // 60 Sekunden statt 30
+        // Leader-Lease: Master erneuert, Standby übernimmt bei Ablauf
+        checkLeaderLease();
+
+        // Zeit-Synchronisation (Slave): Burst, anfangs häufiger bis die Drift geschätzt ist.
+        // Während eines Rennens nur ein Burst kurz vor dem erwarteten Zieleinlauf;
+        // ohne Uhrenmodell zum (neuen) Master sind Event-Zeiten unbrauchbar, dann sofort.
+        if (isSlave())
         {
-            syncTimeWithMaster();
-            lastTimeSync = now;
+            bool newMaster = memcmp(syncedMaster, getMasterMac(), 6) != 0;
+            bool due = now - lastTimeSync > getClockSyncIntervalMs();
+            if (newMaster || ((!raceActive || !hasMasterClock()) && (due || syncPending)))
+            {
+                memcpy(syncedMaster, getMasterMac(), 6);
+                syncTimeWithMaster();
+                lastTimeSync = millis();
+                syncPending = false;
+            }
+            else if (raceActive && expected && !quiet && !prewarmDone &&
+                     remainingUs <= (int64_t)RACE_PREWARM_LEAD_MS * 1000)
+            {
+                prewarmDone = true;
+                if (now - lastTimeSync > RACE_PREWARM_MIN_AGE_MS)
+                {
+                    syncTimeWithMaster();
+                    lastTimeSync = millis();
+                    syncPending = false;
+                    policyStats.prewarmSyncs++;
+                }
+            }
+            else if (raceActive && due && !syncPending)
+            {
+                syncPending = true;
+                policyStats.deferredSyncs++;
+            }
         }
 
-        // Race-Cleanup (Master) - entferne alte beendete Rennen
-        if (isMaster() && (now - lastRaceCleanup > 10000)) // Reduziert von 60000 auf 10000 (10 Sekunden)
+        // Race-Cleanup (Master) - entferne alte beendete Rennen; REMOVE-Deltas erst nach dem Rennen
+        if (isMaster() && (now - lastRaceCleanup > 10000 || cleanupPending))
         {
-            cleanupFinishedRaces();
+            if (raceActive)
+            {
+                if (!cleanupPending)
+                    policyStats.deferredCleanups++;
+                cleanupPending = true;
+            }
+            else
+            {
+                cleanupFinishedRaces();
+                cleanupPending = false;
+            }
             lastRaceCleanup = now;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000)); // 1 Sekunde warten
+        // Kurze Periode, damit Ruhefenster und Pre-Warm-Burst rechtzeitig greifen
+        vTaskDelay(pdMS_TO_TICKS(MASTER_TASK_PERIOD_MS));
     }
 }
 
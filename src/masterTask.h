@@ -6,8 +6,28 @@
 #include <espnow.h>
 #include <Utility.h>
 
+// Funk-Politik während laufender Rennen (Zeiten relativ zum erwarteten Zieleinlauf)
+#define RACE_QUIET_LEAD_MS 3000    // Ruhefenster beginnt so lange vor dem erwarteten Ziel
+#define RACE_QUIET_TAIL_MS 3000    // und endet so lange danach
+#define RACE_PREWARM_LEAD_MS 10000 // Sync-Burst frühestens so lange vor dem Ziel
+#define RACE_PREWARM_MIN_AGE_MS 5000 // Jüngere Syncs gelten als warm
+#define HEARTBEAT_MAX_GAP_MS 12000  // Auch im Ruhefenster, unter dem Master-Timeout der Slaves
+#define MASTER_TASK_PERIOD_MS 100
+
+struct RadioPolicyStats
+{
+    bool raceActive;            // Mindestens ein Rennen läuft
+    bool quiet;                 // Ruhefenster um den erwarteten Zieleinlauf
+    uint32_t deferredHeartbeats; // Im Ruhefenster zurückgestellt
+    uint32_t deferredSyncs;      // Reguläre Syncs während eines Rennens ausgelassen
+    uint32_t prewarmSyncs;       // Sync-Burst vor dem erwarteten Zieleinlauf
+    uint32_t deferredCleanups;   // Aufräumen auf das Rennende verschoben
+    uint32_t catchUps;           // Nachgeholte Aufgaben nach dem letzten Rennen
+};
+
 extern TaskHandle_t masterTaskHandle;
 void initMasterTask();
 void cleanupFinishedRaces();
+RadioPolicyStats getRadioPolicyStats();
 
 #endif
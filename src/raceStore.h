@@ -0,0 +1,195 @@
+#ifndef RACE_STORE_H
+#define RACE_STORE_H
+
+#include <stdint.h>
+
+// Race-Liste mit fester Kapazität: Ringpuffer, Index 0 = ältestes Rennen.
+// Kein Heap nach dem Start; Laufzähler, Suche nach raceId und letztes beendetes
+// Rennen in O(1). Entry braucht isFinished und raceId. isFinished nur über
+// finish() setzen, raceId nach push() nicht mehr ändern; alle anderen Felder
+// dürfen über operator[] direkt geändert werden.
+template <typename Entry, uint16_t N>
+class RaceStore
+{
+    static_assert(N > 0, "N muss größer 0 sein");
+    static_assert(N < 0x8000, "N zu groß für die ID-Tabelle");
+
+public:
+    RaceStore() { clear(); }
+
+    uint16_t size() const { return count; }
+    uint16_t capacity() const { return N; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    uint16_t runningCount() const { return running; }
+
+    Entry &operator[](uint16_t i) { return slots[slotOf(i)]; }
+    const Entry &operator[](uint16_t i) const { return slots[slotOf(i)]; }
+
+    // Hängt ein Rennen an; liefert false wenn voll (nichts geändert)
+    bool push(const Entry &entry)
+    {
+        if (count == N)
+            return false;
+        uint16_t slot = slotOf(count);
+        slots[slot] = entry;
+        finishSeq[slot] = 0;
+        insertId(slot);
+        count++;
+        if (entry.isFinished)
+            markFinished(count - 1);
+        else
+            running++;
+        return true;
+    }
+
+    // Index des Rennens mit dieser ID, -1 wenn nicht vorhanden
+    int indexOf(uint16_t raceId) const
+    {
+        for (uint16_t pos = raceId % TABLE_SIZE; idTable[pos] != NO_SLOT; pos = (pos + 1) % TABLE_SIZE)
+        {
+            if (slots[idTable[pos]].raceId == raceId)
+                return (idTable[pos] + N - head) % N;
+        }
+        return -1;
+    }
+
+    // Markiert ein laufendes Rennen als beendet, die übrigen Felder setzt der Aufrufer
+    void finish(uint16_t i)
+    {
+        Entry &entry = slots[slotOf(i)];
+        if (!entry.isFinished)
+        {
+            entry.isFinished = true;
+            running--;
+        }
+        markFinished(i);
+    }
+
+    // Zuletzt beendetes Rennen, nullptr wenn keines in der Liste
+    const Entry *lastFinished() const
+    {
+        return lastFinishedIndex < 0 ? nullptr : &slots[slotOf(lastFinishedIndex)];
+    }
+
+    // Entfernt ein Rennen; vorne O(1), sonst rücken die jüngeren nach
+    void erase(uint16_t i)
+    {
+        if (i >= count)
+            return;
+        if (!slots[slotOf(i)].isFinished)
+            running--;
+        removeId(slotOf(i));
+
+        if (i == 0)
+        {
+            head = (head + 1) % N;
+        }
+        else
+        {
+            for (uint16_t j = i; j + 1 < count; j++)
+            {
+                uint16_t from = slotOf(j + 1), to = slotOf(j);
+                slots[to] = slots[from];
+                finishSeq[to] = finishSeq[from];
+                moveId(from, to);
+            }
+        }
+        count--;
+
+        if (lastFinishedIndex > i)
+            lastFinishedIndex--;
+        else if (lastFinishedIndex == i)
+            findLastFinished();
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+        running = 0;
+        lastFinishedIndex = -1;
+        finishCounter = 0;
+        for (uint16_t pos = 0; pos < TABLE_SIZE; pos++)
+            idTable[pos] = NO_SLOT;
+    }
+
+private:
+    // ID-Tabelle: raceId % TABLE_SIZE, bei Kollision der nächste freie Platz.
+    // Doppelte Größe hält die Sondierketten bei voller Liste kurz.
+    static constexpr uint16_t TABLE_SIZE = 2 * N;
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+    uint16_t slotOf(uint16_t i) const { return (head + i) % N; }
+
+    void markFinished(uint16_t i)
+    {
+        finishSeq[slotOf(i)] = ++finishCounter;
+        lastFinishedIndex = i;
+    }
+
+    // Platz in der ID-Tabelle, der auf diesen Slot zeigt
+    uint16_t idPosOf(uint16_t slot) const
+    {
+        uint16_t pos = slots[slot].raceId % TABLE_SIZE;
+        while (idTable[pos] != slot)
+            pos = (pos + 1) % TABLE_SIZE;
+        return pos;
+    }
+
+    void insertId(uint16_t slot)
+    {
+        uint16_t pos = slots[slot].raceId % TABLE_SIZE;
+        while (idTable[pos] != NO_SLOT)
+            pos = (pos + 1) % TABLE_SIZE;
+        idTable[pos] = slot;
+    }
+
+    void moveId(uint16_t from, uint16_t to) { idTable[idPosOf(from)] = to; }
+
+    // Entfernen ohne Grabsteine: spätere Einträge der Kette rücken auf die Lücke nach
+    void removeId(uint16_t slot)
+    {
+        uint16_t gap = idPosOf(slot);
+        idTable[gap] = NO_SLOT;
+        for (uint16_t pos = (gap + 1) % TABLE_SIZE; idTable[pos] != NO_SLOT; pos = (pos + 1) % TABLE_SIZE)
+        {
+            uint16_t home = slots[idTable[pos]].raceId % TABLE_SIZE;
+            // Bleibt nur stehen, wenn sein Stammplatz zyklisch zwischen Lücke und pos liegt
+            bool reachable = gap <= pos ? (home > gap && home <= pos) : (home > gap || home <= pos);
+            if (!reachable)
+            {
+                idTable[gap] = idTable[pos];
+                idTable[pos] = NO_SLOT;
+                gap = pos;
+            }
+        }
+    }
+
+    // Nach dem Entfernen des letzten beendeten: das mit der höchsten Beendigungsnummer
+    void findLastFinished()
+    {
+        lastFinishedIndex = -1;
+        uint32_t best = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint16_t slot = slotOf(i);
+            if (slots[slot].isFinished && finishSeq[slot] > best)
+            {
+                best = finishSeq[slot];
+                lastFinishedIndex = i;
+            }
+        }
+    }
+
+    Entry slots[N];
+    uint32_t finishSeq[N];        // Reihenfolge des Beendens je Slot, 0 = laufend
+    uint16_t idTable[TABLE_SIZE]; // Slot je Platz, NO_SLOT = frei
+    uint16_t head = 0;
+    uint16_t count = 0;
+    uint16_t running = 0;
+    int lastFinishedIndex = -1; // Index (nicht Slot) des zuletzt beendeten Rennens
+    uint32_t finishCounter = 0;
+};
+
+#endif
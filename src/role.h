@@ -1,6 +1,9 @@
 #ifndef ROLE_H
 #define ROLE_H
-enum Role
+#include <stdint.h>
+
+// Teil des Drahtformats (IdentityMessage, SaveDeviceMessage, RaceEventMessage): feste Breite
+enum Role : uint8_t
 {
     ROLE_IGNORE,
     ROLE_START,
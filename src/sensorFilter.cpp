@@ -0,0 +1,209 @@
+#include <sensorFilter.h>
+#include <string.h>
+#include <math.h>
+
+FilterConfig defaultFilterConfig()
+{
+    FilterConfig cfg;
+    cfg.mode = DEFAULT_FILTER_MODE;
+    cfg.window = DEFAULT_FILTER_WINDOW;
+    cfg.hampelK = DEFAULT_FILTER_HAMPEL_K;
+    cfg.hysteresisCm = DEFAULT_FILTER_HYSTERESIS_CM;
+    cfg.confirmSamples = DEFAULT_FILTER_CONFIRM_SAMPLES;
+    return cfg;
+}
+
+void sanitizeFilterConfig(FilterConfig &cfg)
+{
+    if (cfg.mode > FILTER_HAMPEL)
+        cfg.mode = FILTER_NONE;
+    if (cfg.window < 1)
+        cfg.window = 1;
+    if (cfg.window > FILTER_WINDOW_MAX)
+        cfg.window = FILTER_WINDOW_MAX;
+    if (cfg.window % 2 == 0)
+        cfg.window--; // Ungerade Fenster haben einen eindeutigen Median
+    if (!(cfg.hampelK > 0.0f))
+        cfg.hampelK = DEFAULT_FILTER_HAMPEL_K;
+    if (!(cfg.hysteresisCm >= 0.0f))
+        cfg.hysteresisCm = 0.0f;
+    if (cfg.confirmSamples < 1)
+        cfg.confirmSamples = 1;
+    if (cfg.confirmSamples > FILTER_WINDOW_MAX)
+        cfg.confirmSamples = FILTER_WINDOW_MAX;
+}
+
+void resetFilter(DistanceFilter &f)
+{
+    memset(&f, 0, sizeof(f));
+}
+
+// Ersetzt 'oldValue' im sortierten Fenster durch 'newValue' (Insertion-Schritt)
+static void sortedReplace(float *sorted, uint8_t n, float oldValue, float newValue)
+{
+    uint8_t i = 0;
+    while (i < n && sorted[i] != oldValue)
+        i++;
+    if (i == n)
+        i = n - 1;
+
+    while (i > 0 && sorted[i - 1] > newValue)
+    {
+        sorted[i] = sorted[i - 1];
+        i--;
+    }
+    while (i + 1 < n && sorted[i + 1] < newValue)
+    {
+        sorted[i] = sorted[i + 1];
+        i++;
+    }
+    sorted[i] = newValue;
+}
+
+static void sortedInsert(float *sorted, uint8_t n, float value)
+{
+    uint8_t i = n;
+    while (i > 0 && sorted[i - 1] > value)
+    {
+        sorted[i] = sorted[i - 1];
+        i--;
+    }
+    sorted[i] = value;
+}
+
+// Median der absoluten Abweichungen, Fenster ist klein und fest begrenzt
+static float medianAbsDeviation(const float *sorted, uint8_t n, float median)
+{
+    float dev[FILTER_WINDOW_MAX];
+    uint8_t m = 0;
+    for (uint8_t i = 0; i < n; i++)
+        sortedInsert(dev, m++, fabsf(sorted[i] - median));
+    return dev[n / 2];
+}
+
+bool filterSample(DistanceFilter &f, const FilterConfig &cfg, float dist, int64_t timeUs, float minCm, float maxCm)
+{
+    uint8_t window = cfg.window;
+    if (f.count < window)
+    {
+        f.ring[(f.head + f.count) % window] = dist;
+        sortedInsert(f.sorted, f.count, dist);
+        f.count++;
+    }
+    else
+    {
+        float oldest = f.ring[f.head];
+        f.ring[f.head] = dist;
+        f.head = (f.head + 1) % window;
+        sortedReplace(f.sorted, window, oldest, dist);
+    }
+
+    float median = f.sorted[f.count / 2];
+    float value = dist;
+    if (cfg.mode == FILTER_MEDIAN)
+    {
+        value = median;
+    }
+    else if (cfg.mode == FILTER_HAMPEL && f.count >= 3)
+    {
+        // 1.4826 * MAD schätzt die Standardabweichung bei normalverteiltem Rauschen
+        float sigma = 1.4826f * medianAbsDeviation(f.sorted, f.count, median);
+        if (fabsf(dist - median) > cfg.hampelK * sigma)
+            value = median;
+    }
+    f.filtered = value;
+
+    // Beginn der Roh-Serie merken: Der Filter darf verzögern, der Zeitstempel nicht
+    bool rawHit = (dist >= minCm && dist <= maxCm);
+    if (rawHit && !f.rawHit)
+    {
+        if (f.prevTimeUs > 0)
+        {
+            f.runStartUs = interpolateCrossing(f.prevTimeUs, f.prevDist, timeUs, dist, minCm, maxCm);
+
+            // Der echte Durchgang liegt irgendwo zwischen den beiden Samples
+            int64_t before = f.runStartUs - f.prevTimeUs;
+            int64_t after = timeUs - f.runStartUs;
+            f.runErrorUs = before > after ? before : after;
+        }
+        else
+        {
+            // Erstes Sample nach resetFilter: kein Vorgänger, der Durchgang ist nicht eingegrenzt
+            f.runStartUs = timeUs;
+            f.runErrorUs = -1;
+        }
+    }
+    f.rawHit = rawHit;
+    f.prevTimeUs = timeUs;
+    f.prevDist = dist;
+
+    if (f.active)
+    {
+        // Hysterese: Zum Verlassen muss der Wert den erweiterten Bereich verlassen
+        if (value < minCm - cfg.hysteresisCm || value > maxCm + cfg.hysteresisCm)
+        {
+            f.active = false;
+            f.hitStreak = 0;
+        }
+    }
+    else if (value >= minCm && value <= maxCm)
+    {
+        if (++f.hitStreak >= cfg.confirmSamples)
+            f.active = true;
+    }
+    else
+    {
+        f.hitStreak = 0;
+    }
+
+    return f.active;
+}
+
+int64_t interpolateCrossing(int64_t prevUs, float prevDist, int64_t timeUs, float dist, float minCm, float maxCm)
+{
+    if (timeUs <= prevUs)
+        return timeUs;
+
+    // Ohne Echo gibt es keine Distanz-Information: Mitte des Intervalls ist erwartungstreu.
+    // Bei einem Sprung hinge der lineare Anteil nur vom Abstand des Hintergrunds zur
+    // Schwelle ab, nicht vom Zeitpunkt des Eintretens: auch dort die Mitte.
+    float fraction = 0.5f;
+    float jump = prevDist > dist ? prevDist - dist : dist - prevDist;
+    if (prevDist < MAX_DISTANCE_CM && jump <= CROSSING_RAMP_MAX_CM)
+    {
+        float threshold = (prevDist > maxCm) ? maxCm : minCm;
+        float span = prevDist - dist;
+        if (span != 0.0f)
+            fraction = (prevDist - threshold) / span;
+    }
+    if (fraction < 0.0f)
+        fraction = 0.0f;
+    if (fraction > 1.0f)
+        fraction = 1.0f;
+
+    return prevUs + (int64_t)((timeUs - prevUs) * fraction);
+}
+
+const char *filterModeToString(FilterMode mode)
+{
+    switch (mode)
+    {
+    case FILTER_NONE:
+        return "none";
+    case FILTER_MEDIAN:
+        return "median";
+    case FILTER_HAMPEL:
+        return "hampel";
+    default:
+        return "unknown";
+    }
+}
+
+FilterMode stringToFilterMode(const char *text)
+{
+    if (strcmp(text, "median") == 0)
+        return FILTER_MEDIAN;
+    if (strcmp(text, "hampel") == 0)
+        return FILTER_HAMPEL;
+    return FILTER_NONE;
+}
@@ -0,0 +1,87 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+
+// Plattformunabhängig (kein Arduino.h), damit die Logik auch auf dem Host läuft
+
+#define FILTER_WINDOW_MAX 9
+
+// Distanz, die bei fehlendem Echo gemeldet wird
+#ifndef MAX_DISTANCE_CM
+#define MAX_DISTANCE_CM 400.0f
+#endif
+
+#ifndef DEFAULT_FILTER_MODE
+#define DEFAULT_FILTER_MODE FILTER_MEDIAN
+#endif
+#ifndef DEFAULT_FILTER_WINDOW
+#define DEFAULT_FILTER_WINDOW 3
+#endif
+#ifndef DEFAULT_FILTER_HAMPEL_K
+#define DEFAULT_FILTER_HAMPEL_K 3.0f
+#endif
+#ifndef DEFAULT_FILTER_HYSTERESIS_CM
+#define DEFAULT_FILTER_HYSTERESIS_CM 5.0f
+#endif
+#ifndef DEFAULT_FILTER_CONFIRM_SAMPLES
+#define DEFAULT_FILTER_CONFIRM_SAMPLES 1
+#endif
+
+// Größte Distanzänderung zwischen zwei Samples, die noch als Annäherung gilt
+// (Sprint mit 10 m/s bei 20 ms Abstand); größere Sprünge sind seitliches Eintreten
+#ifndef CROSSING_RAMP_MAX_CM
+#define CROSSING_RAMP_MAX_CM 20.0f
+#endif
+
+enum FilterMode
+{
+    FILTER_NONE,   // Rohwert entscheidet
+    FILTER_MEDIAN, // Gleitender Median über das Fenster
+    FILTER_HAMPEL  // Rohwert, Ausreißer werden durch den Median ersetzt
+};
+
+struct FilterConfig
+{
+    FilterMode mode;
+    uint8_t window;         // Fenstergröße (ungerade, 1..FILTER_WINDOW_MAX)
+    float hampelK;          // Ausreißer-Schwelle in MAD-Einheiten
+    float hysteresisCm;     // Zusatzabstand zum Verlassen des Trigger-Bereichs
+    uint8_t confirmSamples; // Aufeinanderfolgende Treffer bis zur Auslösung
+};
+
+// Ringpuffer + Entscheidungszustand, fest dimensioniert (keine Allokation)
+struct DistanceFilter
+{
+    float ring[FILTER_WINDOW_MAX];
+    float sorted[FILTER_WINDOW_MAX];
+    uint8_t head;
+    uint8_t count;
+    bool active;         // Gefilterte Entscheidung: Objekt im Bereich
+    uint8_t hitStreak;   // Aufeinanderfolgende Treffer (gefiltert)
+    bool rawHit;         // Letzter Rohwert lag im Bereich
+    int64_t runStartUs;  // Interpolierter Eintrittszeitpunkt der aktuellen Serie
+    int64_t runErrorUs;  // Größter Abstand von runStartUs zu den umschließenden Samples, -1 = unbekannt
+    int64_t prevTimeUs;  // Letztes Sample (für die Interpolation)
+    float prevDist;
+    float filtered;      // Letzter gefilterter Wert
+};
+
+FilterConfig defaultFilterConfig();
+void sanitizeFilterConfig(FilterConfig &cfg);
+void resetFilter(DistanceFilter &f);
+
+// Verarbeitet ein Sample in O(FILTER_WINDOW_MAX) und liefert die Entscheidung.
+// runStartUs zeigt danach auf den zwischen letztem Fehl- und erstem Roh-Treffer
+// interpolierten Schwellen-Durchgang, so dass weder Filterverzögerung noch
+// Abtastperiode in den Auslösezeitpunkt eingehen.
+bool filterSample(DistanceFilter &f, const FilterConfig &cfg, float dist, int64_t timeUs, float minCm, float maxCm);
+
+// Schätzt den Durchgang durch [minCm, maxCm] zwischen zwei Samples: linear bei
+// einer Annäherung, Intervallmitte bei einem Sprung (Hintergrund -> Läufer)
+int64_t interpolateCrossing(int64_t prevUs, float prevDist, int64_t timeUs, float dist, float minCm, float maxCm);
+
+const char *filterModeToString(FilterMode mode);
+FilterMode stringToFilterMode(const char *text);
+
+#endif
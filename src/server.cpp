@@ -1,5 +1,7 @@
 #include <server.h>
 #include <data.h>
+#include <masterTask.h>
+#include <memory>
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
@@ -9,9 +11,17 @@ void wsBrodcastMessage(String message)
   ws.textAll(message);
 }
 
-void broadcastLastTime(unsigned long lastTime)
+void broadcastLastTime(int64_t lastTime, int64_t errorUs)
 {
-  wsBrodcastMessage("{\"type\":\"lastTime\",\"value\":" + String(lastTime) + "}");
+  // Wert in µs, gerundet wird erst im Browser auf die tragfähigen Stellen
+  JsonDocument doc;
+  doc["type"] = "lastTime";
+  doc["value"] = lastTime;
+  doc["errorUs"] = errorUs;
+  doc["decimals"] = durationDecimals(errorUs);
+  String json;
+  serializeJson(doc, json);
+  wsBrodcastMessage(json);
 }
 
 void broadcastSavedDevices()
@@ -38,12 +48,42 @@ void broadcastMasterStatus()
   wsBrodcastMessage(json);
 }
 
-void broadcastLichtschrankeStatus(LichtschrankeStatus status)
+// Sensor-Gesundheit aller Kanäle, für /api/sensor_health und initial_state
+void fillSensorHealthJson(JsonArray channels)
+{
+  for (uint8_t i = 0; i < getSensorChannelCount(); i++) {
+    SensorHealthStats h = getSensorHealthStats(i);
+    JsonObject ch = channels.add<JsonObject>();
+    ch["channel"] = i;
+    ch["samples"] = h.samples;
+    ch["samplesPerSecond"] = h.samplesPerSecond;
+    ch["timeouts"] = h.timeouts;
+    ch["timeoutRatio"] = h.samples ? (float)h.timeouts / h.samples : 0.0f;
+    ch["skippedPings"] = h.skippedPings;
+    ch["cooldownRejections"] = h.cooldownRejections;
+    JsonObject statusTime = ch["statusTimeMs"].to<JsonObject>();
+    for (int s = 0; s < STATUS_COUNT; s++) {
+      statusTime[statusToString((LichtschrankeStatus)s)] = h.statusTimeUs[s] / 1000;
+    }
+    JsonArray histogram = ch["distanceHistogram"].to<JsonArray>();
+    for (int b = 0; b < HEALTH_DISTANCE_BUCKETS; b++) {
+      JsonObject bucket = histogram.add<JsonObject>();
+      if (b < HEALTH_DISTANCE_BUCKETS - 1) {
+        bucket["fromCm"] = b * HEALTH_DISTANCE_BUCKET_CM;
+      } else {
+        bucket["noEcho"] = true;
+      }
+      bucket["count"] = h.distanceHistogram[b];
+    }
+  }
+}
+
+void broadcastLichtschrankeStatus(LichtschrankeStatus status, uint8_t channel)
 {
   // Immer senden - kein Caching für Status-Updates
-  String currentJson = "{\"type\":\"status\",\"status\":\"" + statusToString(status) + "\"}";
+  String currentJson = "{\"type\":\"status\",\"status\":\"" + statusToString(status) + "\",\"channel\":" + String(channel) + "}";
   wsBrodcastMessage(currentJson);
-  Serial.printf("[WS_DEBUG] Status gesendet: %s\n", statusToString(status).c_str());
+  Serial.printf("[WS_DEBUG] Status Kanal %d gesendet: %s\n", channel, statusToString(status).c_str());
 }
 
 // Passe die WebSocket-Init an:
@@ -59,11 +99,18 @@ void initWebsocket()
       doc["type"] = "initial_state";
       JsonObject data = doc.createNestedObject("data");
       data["status"] = statusToString(getStatus());
+      JsonArray channelStatus = data["channelStatus"].to<JsonArray>();
+      for (uint8_t i = 0; i < getSensorChannelCount(); i++) {
+        channelStatus.add(statusToString(getStatus(i)));
+      }
+      fillSensorHealthJson(data["sensorHealth"].to<JsonArray>());
       data["master_status"] = masterStatusToString(getMasterStatus());
       if (isSlave()) {
         data["masterMac"] = macToShortString(getMasterMac());
       }
       data["lastTime"] = getLastTime();
+      data["lastTimeErrorUs"] = getLastTimeErrorUs();
+      data["lastTimeDecimals"] = durationDecimals(getLastTimeErrorUs());
       // saved_devices und discovered_devices sind bereits JSON-Strings, daher als JsonArray parsen
       JsonDocument savedDoc, discoveredDoc;
       deserializeJson(savedDoc, getSavedDevicesJson());
@@ -111,6 +158,18 @@ void initWebpage()
     if (isSlave()) {
         doc["masterMac"] = macToShortString(getMasterMac());
     }
+    LeaseStatus lease = getLeaseStatus();
+    JsonObject leaseObj = doc["lease"].to<JsonObject>();
+    leaseObj["term"] = lease.term;
+    leaseObj["standbyMac"] = lease.hasStandby ? macToShortString(lease.standbyMac) : "";
+    leaseObj["isStandby"] = lease.isStandby;
+    leaseObj["ageMs"] = lease.leaseAgeMs;
+    leaseObj["standbyVersion"] = lease.standbyVersion;
+    leaseObj["failovers"] = lease.failovers;
+    leaseObj["splitBrains"] = lease.splitBrains;
+    leaseObj["standbyChanges"] = lease.standbyChanges;
+    leaseObj["handedOver"] = lease.handedOver;
+    leaseObj["lostOnStepDown"] = lease.lostOnStepDown;
     doc["firmware_hash"] = ESP.getSketchMD5();
     
     // Berechne Filesystem-Hash zur Laufzeit
@@ -147,6 +206,16 @@ void initWebpage()
             {
     JsonDocument doc;
     doc["lastTime"] = getLastTime();
+    doc["errorUs"] = getLastTimeErrorUs();
+    doc["decimals"] = durationDecimals(getLastTimeErrorUs());
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  server.on("/api/races", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    JsonDocument doc;
+    fillRaceListJson(doc["races"].to<JsonArray>());
     String json;
     serializeJson(doc, json);
     request->send(200, "application/json", json); });
@@ -159,6 +228,270 @@ void initWebpage()
     serializeJson(doc, json);
     request->send(200, "application/json", json); });
 
+  server.on("/trace/start", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    Serial.println("[WEB] POST /trace/start aufgerufen.");
+    if (startTrace()) {
+      request->send(200, "text/plain", "Aufzeichnung gestartet");
+    } else {
+      request->send(500, "text/plain", "Kein Speicher für die Aufzeichnung");
+    } });
+
+  server.on("/trace/stop", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    Serial.println("[WEB] POST /trace/stop aufgerufen.");
+    stopTrace();
+    request->send(200, "text/plain", "Aufzeichnung gestoppt"); });
+
+  server.on("/api/trace", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    TraceStatus st = getTraceStatus();
+    JsonDocument doc;
+    doc["recording"] = st.recording;
+    doc["count"] = st.count;
+    doc["capacity"] = st.capacity;
+    doc["dropped"] = st.dropped;
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  // Stoppt die Aufzeichnung und streamt den RAM-Ring als CSV (chunked, ohne Flash)
+  server.on("/trace/download", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    Serial.println("[WEB] GET /trace/download aufgerufen.");
+    std::shared_ptr<TraceExport> csv = std::make_shared<TraceExport>();
+    if (csv->empty()) {
+      request->send(404, "text/plain", "Keine Aufzeichnung vorhanden");
+      return;
+    }
+    AsyncWebServerResponse *response = request->beginChunkedResponse("text/csv", [csv](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+                                                                     { return csv->read(buffer, maxLen); });
+    response->addHeader("Content-Disposition", "attachment; filename=\"trace.csv\"");
+    request->send(response); });
+
+  server.on("/api/espnow", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    EspNowTimingStats stats = getEspNowTimingStats();
+    JsonDocument doc;
+    doc["clusterId"] = getClusterId();
+    doc["rxFrames"] = stats.rxFrames;
+    doc["rxRejected"] = stats.rxRejected;
+    doc["rxForeignCluster"] = stats.rxForeignCluster;
+    doc["rxQueueDepth"] = stats.rxQueueDepth;
+    doc["rxQueueHighWater"] = stats.rxQueueHighWater;
+    doc["rxDropped"] = stats.rxDropped;
+    doc["avgRxHandlingUs"] = stats.rxFrames ? stats.rxHandlingSumUs / stats.rxFrames : 0;
+    doc["maxRxHandlingUs"] = stats.maxRxHandlingUs;
+    doc["txFrames"] = stats.txFrames;
+    doc["txBroadcasts"] = stats.txBroadcasts;
+    doc["txErrors"] = stats.txErrors;
+    doc["txFailed"] = stats.txFailed;
+    doc["avgTxCompleteUs"] = stats.txCompleted ? stats.txCompleteSumUs / stats.txCompleted : 0;
+    doc["maxTxCompleteUs"] = stats.maxTxCompleteUs;
+    RadioPolicyStats policy = getRadioPolicyStats();
+    JsonObject policyObj = doc["policy"].to<JsonObject>();
+    policyObj["raceActive"] = policy.raceActive;
+    policyObj["quiet"] = stats.quiet;
+    policyObj["quietWindows"] = stats.quietWindows;
+    policyObj["deferredHeartbeats"] = policy.deferredHeartbeats;
+    policyObj["deferredSyncs"] = policy.deferredSyncs;
+    policyObj["prewarmSyncs"] = policy.prewarmSyncs;
+    policyObj["deferredCleanups"] = policy.deferredCleanups;
+    policyObj["catchUps"] = policy.catchUps;
+    EspNowTxClassStats txStats[TX_CLASS_COUNT];
+    getEspNowTxClassStats(txStats);
+    JsonArray txClasses = doc["txClasses"].to<JsonArray>();
+    for (uint8_t c = 0; c < TX_CLASS_COUNT; c++) {
+      JsonObject txClass = txClasses.add<JsonObject>();
+      txClass["name"] = txClassToString(c);
+      txClass["queued"] = txStats[c].queued;
+      txClass["sent"] = txStats[c].sent;
+      txClass["coalesced"] = txStats[c].coalesced;
+      txClass["dropped"] = txStats[c].dropped;
+      txClass["noMemRetries"] = txStats[c].noMemRetries;
+      txClass["depth"] = txStats[c].depth;
+      txClass["highWater"] = txStats[c].highWater;
+      txClass["avgLatencyUs"] = txStats[c].sent ? txStats[c].latencySumUs / txStats[c].sent : 0;
+      txClass["maxLatencyUs"] = txStats[c].maxLatencyUs;
+    }
+    EspNowPeerStats peerStats = getEspNowPeerStats();
+    JsonObject peers = doc["peers"].to<JsonObject>();
+    peers["count"] = peerStats.count;
+    peers["capacity"] = peerStats.capacity;
+    peers["pinned"] = peerStats.pinned;
+    peers["highWater"] = peerStats.highWater;
+    peers["evictions"] = peerStats.evictions;
+    peers["addFailures"] = peerStats.addFailures;
+    RaceLinkStats links[RACE_LINK_PEERS_MAX];
+    int linkCount = getRaceLinkStats(links, RACE_LINK_PEERS_MAX);
+    JsonArray raceEvents = doc["raceEvents"].to<JsonArray>();
+    for (int i = 0; i < linkCount; i++) {
+      JsonObject link = raceEvents.add<JsonObject>();
+      link["mac"] = macToString(links[i].mac);
+      link["sent"] = links[i].sent;
+      link["retries"] = links[i].retries;
+      link["acked"] = links[i].acked;
+      link["lost"] = links[i].lost;
+      link["received"] = links[i].received;
+      link["duplicates"] = links[i].duplicates;
+      link["stale"] = links[i].stale;
+    }
+    RaceJournalStats journalStats = getRaceJournalStats();
+    JsonObject journal = doc["journal"].to<JsonObject>();
+    journal["depth"] = journalStats.depth;
+    journal["capacity"] = journalStats.capacity;
+    journal["persisted"] = journalStats.persisted;
+    journal["restored"] = journalStats.restored;
+    journal["journaled"] = journalStats.journaled;
+    journal["drained"] = journalStats.drained;
+    journal["overflows"] = journalStats.overflows;
+    journal["persists"] = journalStats.persists;
+    journal["stale"] = journalStats.stale;
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  server.on("/api/clock", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    uint8_t macs[CLOCK_PEERS_MAX][6];
+    ClockModel models[CLOCK_PEERS_MAX];
+    int count = getPeerClocks(macs, models, CLOCK_PEERS_MAX);
+    int64_t now = getTimeUs();
+    JsonDocument doc;
+    doc["role"] = isMaster() ? "master" : "slave";
+    JsonArray peers = doc["peers"].to<JsonArray>();
+    for (int i = 0; i < count; i++) {
+      const ClockModel &m = models[i];
+      JsonObject peer = peers.add<JsonObject>();
+      peer["mac"] = macToString(macs[i]);
+      peer["offsetUs"] = clockOffsetAt(m, now);
+      peer["skewPpm"] = m.skewPpm;
+      peer["skewValid"] = m.skewValid;
+      peer["errorUs"] = clockErrorAt(m, now);
+      peer["bursts"] = m.bursts;
+      peer["ageMs"] = (now - m.refLocalUs) / 1000;
+    }
+    if (isMaster()) {
+      int64_t updated[CLOCK_PEERS_MAX];
+      count = getDeviceClocks(macs, models, updated, CLOCK_PEERS_MAX);
+      JsonArray devices = doc["devices"].to<JsonArray>();
+      for (int i = 0; i < count; i++) {
+        const ClockModel &m = models[i];
+        JsonObject device = devices.add<JsonObject>();
+        device["mac"] = macToString(macs[i]);
+        device["offsetUs"] = m.offsetUs;
+        device["skewPpm"] = m.skewPpm;
+        device["skewValid"] = m.skewValid;
+        device["errorUs"] = clockErrorAt(m, now - m.offsetUs); // Jetzt in Gerätezeit
+        device["bursts"] = m.bursts;
+        device["lastUpdateMs"] = (now - updated[i]) / 1000;
+      }
+    }
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  server.on("/api/sensor_health", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    JsonDocument doc;
+    fillSensorHealthJson(doc["channels"].to<JsonArray>());
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  server.on("/reset_sensor_health", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+    Serial.println("[WEB] POST /reset_sensor_health aufgerufen.");
+    resetSensorHealthStats();
+    request->send(200, "text/plain", "Sensor-Statistik zurückgesetzt"); });
+
+  server.on("/api/sensor_timing", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+    SensorTimingStats stats = getSensorTimingStats();
+    SensorPeriods periods = getCurrentSensorPeriods();
+    JsonDocument doc;
+    JsonObject target = doc["targetPeriodMs"].to<JsonObject>();
+    for (int i = 0; i < STATUS_COUNT; i++) {
+        target[statusToString((LichtschrankeStatus)i)] = periods.periodMs[i];
+    }
+    doc["status"] = statusToString(getStatus());
+    doc["samples"] = stats.samples;
+    doc["missedDeadlines"] = stats.missedDeadlines;
+    doc["avgPeriodUs"] = stats.samples ? stats.periodSumUs / stats.samples : 0;
+    doc["minPeriodUs"] = stats.minPeriodUs;
+    doc["maxPeriodUs"] = stats.maxPeriodUs;
+    doc["maxJitterUs"] = stats.maxJitterUs;
+    doc["maxTriggerHandlingUs"] = stats.maxTriggerHandlingUs;
+    doc["maxTriggerToNextSampleUs"] = stats.maxTriggerToNextSampleUs;
+    DispatchStats dispatch = getDispatchStats();
+    JsonObject dispatcher = doc["dispatcher"].to<JsonObject>();
+    dispatcher["dispatched"] = dispatch.dispatched;
+    dispatcher["maxLatencyUs"] = dispatch.maxLatencyUs;
+    dispatcher["queueDepth"] = dispatch.queueDepth;
+    dispatcher["queueHighWater"] = dispatch.queueHighWater;
+    dispatcher["dropped"] = dispatch.dropped;
+    JsonArray histogram = doc["jitterHistogram"].to<JsonArray>();
+    for (int i = 0; i < JITTER_BUCKETS; i++) {
+        JsonObject bucket = histogram.add<JsonObject>();
+        if (i < JITTER_BUCKETS - 1) {
+            bucket["belowUs"] = JITTER_BUCKET_LIMITS_US[i];
+        }
+        bucket["count"] = stats.jitterHistogram[i];
+    }
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json); });
+
+  server.on("/set_sensor_periods", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+Serial.println("[WEB] POST /set_sensor_periods aufgerufen.");
+SensorPeriods periods = getSensorPeriods();
+for (int i = 0; i < STATUS_COUNT; i++) {
+  String key = statusToString((LichtschrankeStatus)i);
+  if (request->hasParam(key.c_str(), true)) {
+    periods.periodMs[i] = request->getParam(key.c_str(), true)->value().toInt();
+  }
+}
+setSensorPeriods(periods);
+request->send(200, "text/plain", "Abtastperioden gesetzt"); });
+
+  server.on("/start_calibration", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+Serial.println("[WEB] POST /start_calibration aufgerufen.");
+uint32_t durationMs = BASELINE_CALIBRATION_MS;
+if (request->hasParam("durationMs", true)) {
+  durationMs = request->getParam("durationMs", true)->value().toInt();
+}
+startCalibration(durationMs);
+request->send(200, "text/plain", "Kalibrierung gestartet - Bahn freihalten"); });
+
+  server.on("/api/calibration", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+CalibrationStatus st = getCalibrationStatus();
+JsonDocument doc;
+doc["running"] = st.running;
+doc["durationMs"] = st.durationMs;
+doc["elapsedMs"] = st.elapsedMs;
+doc["hasResult"] = st.hasResult;
+JsonArray channels = doc["channels"].to<JsonArray>();
+for (uint8_t i = 0; i < getSensorChannelCount(); i++) {
+  JsonObject ch = channels.add<JsonObject>();
+  ch["channel"] = i;
+  ch["minDistance"] = getCurrentMinDistance(i);
+  ch["maxDistance"] = getCurrentMaxDistance(i);
+  if (st.hasResult) {
+    const BaselineResult &r = st.results[i];
+    ch["ok"] = r.ok;
+    ch["openLane"] = r.openLane;
+    ch["backgroundCm"] = r.backgroundCm;
+    ch["noiseCm"] = r.noiseCm;
+    ch["echoRatio"] = r.echoRatio;
+  }
+}
+String json;
+serializeJson(doc, json);
+request->send(200, "application/json", json); });
+
   server.on("/config", HTTP_GET, [](AsyncWebServerRequest *request)
             {
       loadDeviceListFromPreferences();
@@ -242,6 +575,13 @@ int maxDistance = getMaxDistance();
 JsonDocument doc;
 doc["minDistance"] = minDistance;
 doc["maxDistance"] = maxDistance;
+JsonArray channels = doc["channels"].to<JsonArray>();
+for (uint8_t i = 0; i < getSensorChannelCount(); i++) {
+  JsonObject ch = channels.add<JsonObject>();
+  ch["channel"] = i;
+  ch["minDistance"] = i == 0 ? minDistance : getMinDistance(i);
+  ch["maxDistance"] = i == 0 ? maxDistance : getMaxDistance(i);
+}
 String json;
 serializeJson(doc, json);
 request->send(200, "application/json", json); });
@@ -251,8 +591,13 @@ request->send(200, "application/json", json); });
 Serial.println("[WEB] POST /set_min_distance aufgerufen.");
 if (request->hasParam("minDistance", true)) {
   int minDistance = request->getParam("minDistance", true)->value().toInt();
-  setMinDistance(minDistance);
-  String msg = "Min-Distanz gesetzt auf " + String(minDistance) + " cm";
+  int channel = request->hasParam("channel", true) ? request->getParam("channel", true)->value().toInt() : 0;
+  if (channel < 0 || channel >= getSensorChannelCount()) {
+    request->send(400, "text/plain", "Ungültiger Kanal");
+    return;
+  }
+  setMinDistance(minDistance, channel);
+  String msg = "Min-Distanz Kanal " + String(channel) + " gesetzt auf " + String(minDistance) + " cm";
   request->send(200, "text/plain", msg);
 } else {
   request->send(400, "text/plain", "Fehlender Min-Distanz-Parameter");
@@ -263,13 +608,77 @@ if (request->hasParam("minDistance", true)) {
 Serial.println("[WEB] POST /set_max_distance aufgerufen.");
 if (request->hasParam("maxDistance", true)) {
   int maxDistance = request->getParam("maxDistance", true)->value().toInt();
-  setMaxDistance(maxDistance);
-  String msg = "Max-Distanz gesetzt auf " + String(maxDistance) + " cm";
+  int channel = request->hasParam("channel", true) ? request->getParam("channel", true)->value().toInt() : 0;
+  if (channel < 0 || channel >= getSensorChannelCount()) {
+    request->send(400, "text/plain", "Ungültiger Kanal");
+    return;
+  }
+  setMaxDistance(maxDistance, channel);
+  String msg = "Max-Distanz Kanal " + String(channel) + " gesetzt auf " + String(maxDistance) + " cm";
   request->send(200, "text/plain", msg);
 } else {
   request->send(400, "text/plain", "Fehlender Max-Distanz-Parameter");
 } });
 
+  server.on("/get_filter_settings", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+Serial.println("[WEB] GET /get_filter_settings aufgerufen.");
+FilterConfig cfg = getFilterConfig();
+JsonDocument doc;
+doc["mode"] = filterModeToString(cfg.mode);
+doc["window"] = cfg.window;
+doc["hampelK"] = cfg.hampelK;
+doc["hysteresis"] = cfg.hysteresisCm;
+doc["confirm"] = cfg.confirmSamples;
+String json;
+serializeJson(doc, json);
+request->send(200, "application/json", json); });
+
+  server.on("/set_filter_settings", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+Serial.println("[WEB] POST /set_filter_settings aufgerufen.");
+FilterConfig cfg = getFilterConfig();
+if (request->hasParam("mode", true)) {
+  cfg.mode = stringToFilterMode(request->getParam("mode", true)->value().c_str());
+}
+if (request->hasParam("window", true)) {
+  cfg.window = request->getParam("window", true)->value().toInt();
+}
+if (request->hasParam("hampelK", true)) {
+  cfg.hampelK = request->getParam("hampelK", true)->value().toFloat();
+}
+if (request->hasParam("hysteresis", true)) {
+  cfg.hysteresisCm = request->getParam("hysteresis", true)->value().toFloat();
+}
+if (request->hasParam("confirm", true)) {
+  cfg.confirmSamples = request->getParam("confirm", true)->value().toInt();
+}
+setFilterConfig(cfg);
+request->send(200, "text/plain", "Filter gesetzt auf " + String(filterModeToString(getCurrentFilterConfig().mode))); });
+
+  server.on("/get_cluster_id", HTTP_GET, [](AsyncWebServerRequest *request)
+            {
+JsonDocument doc;
+doc["clusterId"] = getClusterId();
+String json;
+serializeJson(doc, json);
+request->send(200, "application/json", json); });
+
+  server.on("/set_cluster_id", HTTP_POST, [](AsyncWebServerRequest *request)
+            {
+Serial.println("[WEB] POST /set_cluster_id aufgerufen.");
+if (request->hasParam("clusterId", true)) {
+  long clusterId = request->getParam("clusterId", true)->value().toInt();
+  if (clusterId < 0 || clusterId > 0xFFFF) {
+    request->send(400, "text/plain", "Cluster-ID muss zwischen 0 und 65535 liegen");
+    return;
+  }
+  setClusterId((uint16_t)clusterId);
+  request->send(200, "text/plain", "Cluster-ID gesetzt auf " + String(clusterId));
+} else {
+  request->send(400, "text/plain", "Fehlender Parameter clusterId");
+} });
+
   server.on("/get_brightness", HTTP_GET, [](AsyncWebServerRequest *request)
             {
 Serial.println("[WEB] GET /get_brightness aufgerufen.");
@@ -12,15 +12,16 @@
 #include <task.h>
 #include <timeLogic.h>
 #include <Utility.h>
+#include <trace.h>
 #include <espnow.h>
 
 void wsBrodcastMessage(String message);
 
-void broadcastLichtschrankeStatus(LichtschrankeStatus status);
+void broadcastLichtschrankeStatus(LichtschrankeStatus status, uint8_t channel = 0);
 
 void broadcastMasterStatus();
 
-void broadcastLastTime(unsigned long lastTime);
+void broadcastLastTime(int64_t lastTime, int64_t errorUs = -1);
 
 void broadcastSavedDevices();
 
@@ -1,123 +1,398 @@
 #include <task.h>
 
 unsigned long lastScream = 0;
-LichtschrankeStatus status = STATUS_NORMAL;
-unsigned long lastTrigger = 0;
-unsigned long cooldownUntil = 0;
+
+// Eigene Status-Maschine pro Sensor-Kanal (triggerLogic)
+TriggerState channelStates[SENSOR_CHANNELS] = {};
+
+SensorPeriods cachedPeriods = {{SENSOR_PERIOD_NORMAL_MS, SENSOR_PERIOD_TRIGGERED_MS,
+                                SENSOR_PERIOD_COOLDOWN_MS, SENSOR_PERIOD_TRIGGERED_IN_COOLDOWN_MS}};
+SensorTimingStats timingStats;
+DispatchStats dispatchStats;
+SensorHealthStats healthStats[SENSOR_CHANNELS];
+
+// Zustand des Kanals verbuchen: Rate, Timeouts, Distanzverteilung, Zeit je Status
+void recordSensorHealth(const MeasureResult &res, LichtschrankeStatus prevStatus)
+{
+    SensorHealthStats &h = healthStats[res.channel];
+
+    if (h.lastSampleUs != 0 && res.time > h.lastSampleUs)
+        h.statusTimeUs[prevStatus] += res.time - h.lastSampleUs;
+    h.lastSampleUs = res.time;
+
+    h.samples++;
+    int bucket = HEALTH_DISTANCE_BUCKETS - 1;
+    if (res.echo)
+    {
+        bucket = (int)(res.distance / HEALTH_DISTANCE_BUCKET_CM);
+        if (bucket > HEALTH_DISTANCE_BUCKETS - 2)
+            bucket = HEALTH_DISTANCE_BUCKETS - 2;
+    }
+    else
+    {
+        h.timeouts++;
+    }
+    h.distanceHistogram[bucket]++;
+
+    h.windowSamples++;
+    if (h.windowStartUs == 0)
+    {
+        h.windowStartUs = res.time;
+    }
+    else if (res.time - h.windowStartUs >= 1000000)
+    {
+        h.samplesPerSecond = h.windowSamples * 1000000.0f / (res.time - h.windowStartUs);
+        h.windowSamples = 0;
+        h.windowStartUs = res.time;
+    }
+}
+
+// Ist-Periode gegen die Soll-Periode verbuchen
+void recordSensorPeriod(int64_t actualUs, int64_t targetUs)
+{
+    int64_t jitter = actualUs > targetUs ? actualUs - targetUs : targetUs - actualUs;
+
+    timingStats.samples++;
+    timingStats.periodSumUs += actualUs;
+    if (timingStats.minPeriodUs == 0 || actualUs < timingStats.minPeriodUs)
+        timingStats.minPeriodUs = actualUs;
+    if (actualUs > timingStats.maxPeriodUs)
+        timingStats.maxPeriodUs = actualUs;
+    if (jitter > timingStats.maxJitterUs)
+        timingStats.maxJitterUs = jitter;
+
+    int bucket = 0;
+    while (bucket < JITTER_BUCKETS - 1 && jitter >= JITTER_BUCKET_LIMITS_US[bucket])
+        bucket++;
+    timingStats.jitterHistogram[bucket]++;
+}
+
+// Ereignisse vom Sensor-Task (Core 1) an den Dispatcher (Core 0)
+SpscRing<SensorEvent, SENSOR_EVENT_QUEUE_SIZE> sensorEvents;
+TaskHandle_t dispatcherTaskHandle = NULL;
+
+// Nur Zeitstempel + Queue-Push im Sensor-Pfad, kein Serial/WebSocket/ESP-NOW
+static void pushSensorEvent(SensorEventType type, uint8_t channel, int64_t timeUs, float distance, uint32_t errorUs = 0)
+{
+    SensorEvent ev;
+    ev.type = type;
+    ev.status = channelStates[channel].status;
+    ev.channel = channel;
+    ev.timeUs = timeUs;
+    ev.queuedUs = getTimeUs();
+    ev.distance = distance;
+    ev.errorUs = errorUs;
+    sensorEvents.push(ev);
+    if (dispatcherTaskHandle != NULL)
+    {
+        xTaskNotifyGive(dispatcherTaskHandle);
+    }
+}
+
+// Kalibrierung: Anforderung vom Webserver, Auswertung im Sensor-Task
+static std::atomic<uint32_t> calibrationRequestMs{0};
+static volatile bool calibrationRunning = false;
+static int64_t calibrationStartUs = 0;
+static uint32_t calibrationDurationMs = 0;
+static bool calibrationHasResult = false;
+BaselineCalibration calibrations[SENSOR_CHANNELS];
+BaselineResult calibrationResults[SENSOR_CHANNELS];
+
+// Drift-Nachführung im Leerlauf, höchstens einmal pro Minute gespeichert
+#define BASELINE_DRIFT_INTERVAL_US 60000000LL
+BaselineDrift drifts[SENSOR_CHANNELS];
+int64_t lastDriftUpdateUs[SENSOR_CHANNELS] = {0};
+
+// Liefert true solange kalibriert wird; die Samples gehen dann nicht in die Status-Maschine
+static bool updateCalibration(const MeasureResult &res)
+{
+    uint32_t requestMs = calibrationRequestMs.exchange(0);
+    if (requestMs != 0)
+    {
+        for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+        {
+            resetCalibration(calibrations[i]);
+            setFullEchoRange(i, true);
+        }
+        calibrationDurationMs = requestMs;
+        calibrationStartUs = res.time;
+        calibrationRunning = true;
+        return true; // Dieses Sample lief noch mit der begrenzten Echo-Wartezeit
+    }
+    if (!calibrationRunning)
+        return false;
+
+    addCalibrationSample(calibrations[res.channel], res.distance);
+    if (res.time - calibrationStartUs < (int64_t)calibrationDurationMs * 1000)
+        return true;
+
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+    {
+        calibrationResults[i] = deriveThresholds(calibrations[i], getCurrentMinDistance(i));
+        if (calibrationResults[i].ok)
+        {
+            resetDrift(drifts[i], calibrationResults[i].openLane ? 0.0f : calibrationResults[i].backgroundCm);
+            lastDriftUpdateUs[i] = res.time;
+        }
+    }
+    calibrationHasResult = true;
+    calibrationRunning = false;
+    return false;
+}
+
+// Auf die nächste absolute Deadline warten: Der aktivste Kanal bestimmt den Takt,
+// jeder Kanal wird damit alle SENSOR_CHANNELS Perioden gemessen. Kürzer als die
+// Echo-Wartezeit geht nicht, sonst reißt jede Messung ihre Deadline.
+// advance = false: derselbe Kanal kommt erneut dran (Ping ausgelassen).
+// Liefert die verschlafene Zeit in µs.
+static int64_t waitNextPeriod(TickType_t &lastWakeTick, int64_t &lastWakeUs, uint8_t &channel, bool advance = true)
+{
+    uint16_t periodMs = cachedPeriods.periodMs[channelStates[0].status];
+    for (uint8_t i = 1; i < SENSOR_CHANNELS; i++)
+    {
+        uint16_t p = cachedPeriods.periodMs[channelStates[i].status];
+        if (p < periodMs)
+            periodMs = p;
+    }
+    uint16_t minPeriodMs = getMinSensorPeriodMs();
+    if (periodMs < minPeriodMs)
+        periodMs = minPeriodMs;
+
+    if (advance)
+        channel = (channel + 1) % SENSOR_CHANNELS;
+    int64_t sleepStartUs = getTimeUs();
+    if (xTaskDelayUntil(&lastWakeTick, pdMS_TO_TICKS(periodMs)) == pdFALSE)
+    {
+        // Deadline verpasst: neu verankern statt mit einem Burst aufzuholen
+        timingStats.missedDeadlines++;
+        lastWakeTick = xTaskGetTickCount();
+    }
+    int64_t wakeUs = getTimeUs();
+    recordSensorPeriod(wakeUs - lastWakeUs, (int64_t)periodMs * 1000);
+    lastWakeUs = wakeUs;
+    return wakeUs - sleepStartUs;
+}
 
 void lichtschrankeTask(void *pvParameters)
 {
-    // Cache für bessere Performance
-    Role cachedRole = getOwnRole();
-    bool isMasterCached = isMaster();
+    // Feste Deadlines: Messdauer und Verdrängung verschieben die Abtastrate nicht
+    TickType_t lastWakeTick = xTaskGetTickCount();
+    int64_t lastWakeUs = getTimeUs();
+    int64_t pendingTriggerUs = 0; // Erkennung des letzten Triggers, bis zur nächsten Messung
+    int64_t sleptUs = 0;          // Geplanter Schlaf seit der Erkennung, zählt nicht als Kosten
+    uint8_t channel = 0;          // Kanäle werden reihum gefeuert, nie gleichzeitig
 
     for (;;)
     {
-        MeasureResult res = measure();
-        LichtschrankeStatus prevStatus = status;
-        if (res.triggered && status == STATUS_NORMAL && res.time >= cooldownUntil)
+        if (pendingTriggerUs != 0)
+        {
+            // Nur die Arbeit zwischen Erkennung und nächster Messung, ohne den Periodenschlaf
+            int64_t gap = getTimeUs() - pendingTriggerUs - sleptUs;
+            if (gap > timingStats.maxTriggerToNextSampleUs)
+                timingStats.maxTriggerToNextSampleUs = gap;
+            pendingTriggerUs = 0;
+        }
+
+        MeasureResult res;
+        if (!measure(channel, res))
         {
-            // Sofortige Zeiterfassung für maximale Genauigkeit
-            unsigned long triggerTime = micros() / 1000; // Mikrosekunden-Genauigkeit
-
-            Serial.printf("*** TRIGGER ERKANNT! Zeit: %lu, Rolle: %d, Master: %s ***\n",
-                          triggerTime, cachedRole, isMasterCached ? "JA" : "NEIN");
-
-            // Optimierte Rolle-Abfrage ohne Funktionsaufruf
-            if (cachedRole == ROLE_START)
-            {
-                Serial.println("-> START-Sensor ausgelöst");
-                if (isMasterCached)
-                {
-                    masterAddRaceStart(triggerTime, getMacAddress(), triggerTime);
-                }
-                else
-                {
-                    slaveHandleRaceStart(triggerTime, getMacAddress(), triggerTime);
-                }
-            }
-            else if (cachedRole == ROLE_ZIEL)
-            {
-                Serial.println("-> ZIEL-Sensor ausgelöst");
-                if (isMasterCached)
-                {
-                    masterFinishRace(triggerTime, getMacAddress(), triggerTime);
-                }
-                else
-                {
-                    slaveHandleRaceFinish(triggerTime, getMacAddress(), triggerTime);
-                }
-            }
-            else
-            {
-                Serial.printf("-> IGNORIERT - Rolle ist %d\n", cachedRole);
-            }
-            lastTrigger = triggerTime;
-            status = STATUS_TRIGGERED;
+            // Kein Sample: zählt weder für Rate noch Filter, nur als ausgelassener Ping.
+            // Der Kanal bleibt dran, sonst verhungert er hinter einem Nachbarn ohne Echo
+            healthStats[channel].skippedPings++;
+            sleptUs += waitNextPeriod(lastWakeTick, lastWakeUs, channel, false);
+            continue;
         }
-        // Optimierte Status-Maschine mit weniger Vergleichen
-        else if (!res.triggered)
+        bool wasCalibrating = calibrationRunning;
+        if (updateCalibration(res))
         {
-            if (status == STATUS_TRIGGERED || status == STATUS_TRIGGERED_IN_COOLDOWN)
-            {
-                status = STATUS_COOLDOWN;
-                cooldownUntil = res.time + COOLDOWN_MS;
-            }
-            else if ((status == STATUS_COOLDOWN || status == STATUS_TRIGGERED_IN_COOLDOWN) && res.time >= cooldownUntil)
-            {
-                status = STATUS_NORMAL;
-            }
+            res.triggered = false; // Leere Bahn wird vermessen, keine Rennen
         }
-        else if (res.triggered)
+        else if (wasCalibrating)
         {
-            if (status == STATUS_COOLDOWN || status == STATUS_TRIGGERED_IN_COOLDOWN)
-            {
-                status = STATUS_TRIGGERED_IN_COOLDOWN;
-                cooldownUntil = res.time + COOLDOWN_MS;
-            }
-            else if (status == STATUS_TRIGGERED && (res.time - lastTrigger > 500))
-            {
-                status = STATUS_COOLDOWN;
-                cooldownUntil = res.time + COOLDOWN_MS;
-            }
+            for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+                pushSensorEvent(SENSOR_EVENT_CALIBRATION, i, res.time, calibrationResults[i].backgroundCm);
         }
+        TriggerState &cs = channelStates[channel];
+        recordSensorHealth(res, cs.status);
+        TriggerStep step = stepTrigger(cs, res, COOLDOWN_US);
+        if (step.fired)
+        {
+            int64_t detectedUs = getTimeUs();
 
-        // WebSocket-Broadcast bei allen wichtigen Status-Änderungen
-        if (status != prevStatus)
+            // Rollen-Auswertung, Rennverwaltung und Versand übernimmt der Dispatcher
+            pushSensorEvent(SENSOR_EVENT_TRIGGER, channel, res.triggerTime, res.distance,
+                            res.triggerErrorUs < 0 ? SENSOR_ERROR_UNKNOWN : (uint32_t)res.triggerErrorUs);
+
+            int64_t handling = getTimeUs() - detectedUs;
+            if (handling > timingStats.maxTriggerHandlingUs)
+                timingStats.maxTriggerHandlingUs = handling;
+            pendingTriggerUs = detectedUs;
+            sleptUs = 0;
+        }
+        if (step.cooldownRejected)
         {
-            Serial.printf("[STATUS] Status-Wechsel: %d -> %d\n", prevStatus, status);
-            broadcastLichtschrankeStatus(status);
+            healthStats[channel].cooldownRejections++;
         }
 
-        // Micro-Optimierung: Minimale Verzögerung bei kritischen Zuständen
-        if (status == STATUS_TRIGGERED)
+        // Langsame Hintergrund-Drift nur bei freier Bahn nachführen
+        float shiftCm = 0.0f;
+        if (!calibrationRunning && cs.status == STATUS_NORMAL && !res.triggered &&
+            trackDrift(drifts[channel], res.distance, shiftCm) &&
+            res.time - lastDriftUpdateUs[channel] > BASELINE_DRIFT_INTERVAL_US)
         {
-            vTaskDelay(pdMS_TO_TICKS(1)); // Maximale Frequenz für Trigger-Erkennung
+            resetDrift(drifts[channel], drifts[channel].averageCm);
+            lastDriftUpdateUs[channel] = res.time;
+            pushSensorEvent(SENSOR_EVENT_BASELINE_DRIFT, channel, res.time, shiftCm);
         }
-        else if (status == STATUS_TRIGGERED_IN_COOLDOWN)
+
+        // WebSocket-Broadcast bei allen wichtigen Status-Änderungen (über den Dispatcher)
+        if (cs.status != step.prevStatus)
         {
-            vTaskDelay(pdMS_TO_TICKS(2)); // Hohe Frequenz während Cooldown
+            pushSensorEvent(SENSOR_EVENT_STATUS, channel, res.time, res.distance);
+        }
+
+        sleptUs += waitNextPeriod(lastWakeTick, lastWakeUs, channel);
+    }
+}
+
+// Kalibrierergebnis speichern (Preferences sind zu langsam für den Sensor-Task)
+static void applyCalibration(uint8_t channel)
+{
+    const BaselineResult &r = calibrationResults[channel];
+    Serial.printf("[CALIBRATION] Kanal %d: %s, Hintergrund %.1f cm, Rauschen %.1f cm, Echo-Quote %.0f%%, Max-Distanz %d cm\n",
+                  channel, r.ok ? "OK" : "FEHLGESCHLAGEN", r.backgroundCm, r.noiseCm, r.echoRatio * 100.0f, r.maxDistance);
+    if (r.ok)
+    {
+        setMaxDistance(r.maxDistance, channel);
+        setBaseline(r.openLane ? 0.0f : r.backgroundCm, r.noiseCm, channel);
+    }
+    // Echo-Wartezeit erst jetzt wieder begrenzen: setMaxDistance hat sie neu berechnet
+    setFullEchoRange(channel, false);
+
+    JsonDocument doc;
+    doc["type"] = "calibration";
+    doc["channel"] = channel;
+    doc["ok"] = r.ok;
+    doc["backgroundCm"] = r.backgroundCm;
+    doc["noiseCm"] = r.noiseCm;
+    doc["maxDistance"] = r.maxDistance;
+    String json;
+    serializeJson(doc, json);
+    wsBrodcastMessage(json);
+}
+
+// Trigger-Bereich mit dem Hintergrund mitschieben
+static void applyBaselineDrift(uint8_t channel, float shiftCm)
+{
+    int minDistance = getCurrentMinDistance(channel);
+    int maxDistance = getCurrentMaxDistance(channel) + (int)roundf(shiftCm);
+    if (maxDistance > BASELINE_THRESHOLD_LIMIT_CM)
+        maxDistance = BASELINE_THRESHOLD_LIMIT_CM;
+    if (maxDistance < minDistance + BASELINE_MIN_SPAN_CM)
+    {
+        Serial.printf("[CALIBRATION] Kanal %d: Drift %.1f cm ignoriert, Bereich wäre zu schmal\n", channel, shiftCm);
+        return;
+    }
+
+    Serial.printf("[CALIBRATION] Kanal %d: Hintergrund um %.1f cm gewandert, Max-Distanz -> %d cm\n", channel, shiftCm, maxDistance);
+    setMaxDistance(maxDistance, channel);
+    setBaseline(getBaseline(channel) + shiftCm, getBaselineNoise(channel), channel);
+}
+
+// Arbeitet Sensor-Ereignisse auf Core 0 ab: Logging, Rennverwaltung, ESP-NOW, WebSocket
+void dispatchSensorEvent(const SensorEvent &ev)
+{
+    int64_t latency = getTimeUs() - ev.queuedUs;
+    if (latency > dispatchStats.maxLatencyUs)
+        dispatchStats.maxLatencyUs = latency;
+    dispatchStats.dispatched++;
+
+    if (ev.type == SENSOR_EVENT_CALIBRATION)
+    {
+        applyCalibration(ev.channel);
+        return;
+    }
+    if (ev.type == SENSOR_EVENT_BASELINE_DRIFT)
+    {
+        applyBaselineDrift(ev.channel, ev.distance);
+        return;
+    }
+    if (ev.type == SENSOR_EVENT_STATUS)
+    {
+        Serial.printf("[STATUS] Kanal %d Status-Wechsel: %d (Distanz %.1fcm)\n", ev.channel, ev.status, ev.distance);
+        broadcastLichtschrankeStatus((LichtschrankeStatus)ev.status, ev.channel);
+        return;
+    }
+
+    Role role = getOwnRole();
+    bool master = isMaster();
+    int64_t triggerTime = ev.timeUs;
+
+    Serial.printf("*** TRIGGER ERKANNT! Kanal: %d, Zeit: %lld us (±%lu us), Distanz: %.1fcm, Rolle: %d, Master: %s, Latenz: %lld us ***\n",
+                  ev.channel, (long long)triggerTime, (unsigned long)ev.errorUs, ev.distance, role, master ? "JA" : "NEIN", (long long)latency);
+
+    if (role == ROLE_START)
+    {
+        Serial.println("-> START-Sensor ausgelöst");
+        if (master)
+        {
+            masterAddRaceStart(triggerTime, getMacAddress(), triggerTime, ev.channel, ev.errorUs);
+        }
+        else
+        {
+            slaveHandleRaceStart(triggerTime, getMacAddress(), triggerTime, ev.channel, ev.errorUs);
+        }
+    }
+    else if (role == ROLE_ZIEL)
+    {
+        Serial.println("-> ZIEL-Sensor ausgelöst");
+        if (master)
+        {
+            masterFinishRace(triggerTime, getMacAddress(), triggerTime, ev.channel, ev.errorUs);
         }
         else
         {
-            vTaskDelay(pdMS_TO_TICKS(5)); // Normal wenn inaktiv
+            slaveHandleRaceFinish(triggerTime, getMacAddress(), triggerTime, ev.channel, ev.errorUs);
         }
+    }
+    else
+    {
+        Serial.printf("-> IGNORIERT - Rolle ist %d\n", role);
+    }
+}
+
+void eventDispatcherTask(void *pvParameters)
+{
+    for (;;)
+    {
+        // Sensor-Task weckt per Notification; Timeout als Rückfallebene
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
 
-        // Cache periodisch aktualisieren
-        static unsigned long lastCacheUpdate = 0;
-        if (res.time - lastCacheUpdate > 10000) // Alle 10 Sekunden
+        SensorEvent ev;
+        while (sensorEvents.pop(ev))
         {
-            Serial.println("[CACHE] Aktualisiere Role/Master-Cache...");
-            cachedRole = getOwnRole();
-            isMasterCached = isMaster();
-            Serial.printf("[CACHE] Neue Werte: Rolle=%d, Master=%s\n", cachedRole, isMasterCached ? "JA" : "NEIN");
-            lastCacheUpdate = res.time;
+            dispatchSensorEvent(ev);
         }
     }
 }
 
 void initLichtschrankeTask()
 {
+    updateSensorPeriodCache();
+
+    // Drift-Nachführung vom gespeicherten Hintergrund aus fortsetzen
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+        resetDrift(drifts[i], getBaseline(i));
+
+    xTaskCreatePinnedToCore(
+        eventDispatcherTask,
+        "EventDispatcher",
+        8192, // ESP-NOW, JSON und WebSocket brauchen Stack
+        NULL,
+        5, // Über dem Master-Task, unter dem WiFi-Stack
+        &dispatcherTaskHandle,
+        0); // Core 0, neben dem Netzwerk
+
     xTaskCreatePinnedToCore(
         lichtschrankeTask,
         "LichtschrankeTask",
@@ -128,7 +403,74 @@ void initLichtschrankeTask()
         1); // Core 1 für beste Performance
 }
 
-LichtschrankeStatus getStatus()
+LichtschrankeStatus getStatus(uint8_t channel)
+{
+    return channel < SENSOR_CHANNELS ? channelStates[channel].status : STATUS_NORMAL;
+}
+
+void updateSensorPeriodCache()
+{
+    cachedPeriods = getSensorPeriods();
+    Serial.printf("[SENSOR_CACHE] Perioden aktualisiert: Normal:%dms Triggered:%dms Cooldown:%dms TriggeredInCooldown:%dms\n",
+                  cachedPeriods.periodMs[STATUS_NORMAL], cachedPeriods.periodMs[STATUS_TRIGGERED],
+                  cachedPeriods.periodMs[STATUS_COOLDOWN], cachedPeriods.periodMs[STATUS_TRIGGERED_IN_COOLDOWN]);
+}
+
+SensorPeriods getCurrentSensorPeriods()
+{
+    return cachedPeriods;
+}
+
+SensorTimingStats getSensorTimingStats()
+{
+    return timingStats;
+}
+
+DispatchStats getDispatchStats()
 {
-    return status;
-}
\ No newline at end of file
+    DispatchStats stats = dispatchStats;
+    stats.queueDepth = sensorEvents.size();
+    stats.queueHighWater = sensorEvents.highWaterMark();
+    stats.dropped = sensorEvents.droppedCount();
+    return stats;
+}
+
+void resetSensorTimingStats()
+{
+    memset(&timingStats, 0, sizeof(timingStats));
+}
+
+SensorHealthStats getSensorHealthStats(uint8_t channel)
+{
+    SensorHealthStats stats = {};
+    if (channel < SENSOR_CHANNELS)
+        stats = healthStats[channel];
+    return stats;
+}
+
+void resetSensorHealthStats()
+{
+    memset(healthStats, 0, sizeof(healthStats));
+}
+
+void startCalibration(uint32_t durationMs)
+{
+    if (durationMs < 1000)
+        durationMs = 1000;
+    if (durationMs > 60000)
+        durationMs = 60000;
+    Serial.printf("[CALIBRATION] Starte Kalibrierung der leeren Bahn für %lu ms\n", (unsigned long)durationMs);
+    calibrationRequestMs.store(durationMs);
+}
+
+CalibrationStatus getCalibrationStatus()
+{
+    CalibrationStatus st;
+    st.running = calibrationRunning || calibrationRequestMs.load() != 0;
+    st.durationMs = calibrationDurationMs;
+    st.elapsedMs = calibrationRunning ? (uint32_t)((getTimeUs() - calibrationStartUs) / 1000) : 0;
+    st.hasResult = calibrationHasResult;
+    for (uint8_t i = 0; i < SENSOR_CHANNELS; i++)
+        st.results[i] = calibrationResults[i];
+    return st;
+}
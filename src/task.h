@@ -5,8 +5,65 @@
 #include <Arduino.h>
 #include <Sensor.h>
 #include <timeLogic.h>
+#include <spscRing.h>
+#include <baseline.h>
+#include <triggerLogic.h>
+
+#ifndef SENSOR_EVENT_QUEUE_SIZE
+#define SENSOR_EVENT_QUEUE_SIZE 16
+#endif
+
+enum SensorEventType : uint8_t
+{
+    SENSOR_EVENT_TRIGGER, // Auslösung (Start/Ziel je nach Rolle)
+    SENSOR_EVENT_STATUS,  // Status-Wechsel der Lichtschranke
+    SENSOR_EVENT_CALIBRATION, // Kalibrierung abgeschlossen, Ergebnis in getCalibrationStatus()
+    SENSOR_EVENT_BASELINE_DRIFT // Hintergrund im Leerlauf gewandert
+};
+
+// Kompaktes Ereignis vom Sensor-Task an den Dispatcher
+struct SensorEvent
+{
+    int64_t timeUs;   // Auslösezeit bzw. Messzeit (µs)
+    int64_t queuedUs; // Zeitpunkt des Push (für die Latenzmessung)
+    float distance;   // Rohdistanz in cm (bei Drift: Verschiebung des Hintergrunds)
+    uint32_t errorUs; // Abtastbedingte Unsicherheit der Auslösezeit (µs)
+    SensorEventType type;
+    uint8_t status;  // LichtschrankeStatus nach dem Ereignis
+    uint8_t channel; // Sensor-Kanal
+};
+
+struct DispatchStats
+{
+    uint32_t dispatched;
+    int64_t maxLatencyUs; // Push bis Verarbeitung
+    uint32_t queueDepth;
+    uint32_t queueHighWater;
+    uint32_t dropped;
+};
+
+struct CalibrationStatus
+{
+    bool running;
+    uint32_t durationMs;
+    uint32_t elapsedMs;
+    bool hasResult;
+    BaselineResult results[SENSOR_CHANNELS];
+};
 
 void initLichtschrankeTask();
-LichtschrankeStatus getStatus();
+LichtschrankeStatus getStatus(uint8_t channel = 0);
+
+void updateSensorPeriodCache();
+SensorPeriods getCurrentSensorPeriods();
+SensorTimingStats getSensorTimingStats();
+DispatchStats getDispatchStats();
+SensorHealthStats getSensorHealthStats(uint8_t channel);
+void resetSensorHealthStats();
+void resetSensorTimingStats();
+
+// Kalibrierung der leeren Bahn, läuft im Sensor-Task; Auslösungen sind währenddessen gesperrt
+void startCalibration(uint32_t durationMs = BASELINE_CALIBRATION_MS);
+CalibrationStatus getCalibrationStatus();
 
 #endif
\ No newline at end of file
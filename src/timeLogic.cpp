@@ -1,13 +1,52 @@
 #include <timeLogic.h>
+#include <esp_timer.h>
 
-unsigned long lastTime = 0;
+int64_t lastTime = 0;
+int64_t lastTimeErrorUs = -1;
 
-unsigned long getLastTime()
+int64_t getTimeUs()
+{
+    return esp_timer_get_time();
+}
+
+unsigned long usToMs(int64_t us)
+{
+    if (us <= 0)
+        return 0;
+    return (unsigned long)((us + 500) / 1000);
+}
+
+uint8_t durationDecimals(int64_t errorUs)
+{
+    // Eine Stelle wird nur angezeigt, wenn der Fehler unter einer halben Einheit liegt
+    if (errorUs < 0)
+        return 1;
+    if (errorUs < 500)
+        return 3;
+    if (errorUs < 5000)
+        return 2;
+    if (errorUs < 50000)
+        return 1;
+    return 0;
+}
+
+int64_t getLastTime()
 {
     return lastTime;
 }
 
-void calcLastTime(unsigned long startTime, unsigned long endTime)
+int64_t getLastTimeErrorUs()
+{
+    return lastTimeErrorUs;
+}
+
+void setLastTime(int64_t duration, int64_t errorUs)
+{
+    lastTime = duration;
+    lastTimeErrorUs = errorUs;
+}
+
+void calcLastTime(int64_t startTime, int64_t endTime)
 {
     lastTime = endTime - startTime;
 }
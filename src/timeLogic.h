@@ -1,6 +1,19 @@
 #ifndef TIMELOGIC_H
 #define TIMELOGIC_H
 
-unsigned long getLastTime();
-void calcLastTime(unsigned long startTime, unsigned long endTime);
-#endif
\ No newline at end of file
+#include <stdint.h>
+
+// 64-bit Mikrosekunden seit Boot (esp_timer_get_time), läuft praktisch nie über
+int64_t getTimeUs();
+
+// Rundung auf Millisekunden erst bei der Ausgabe
+unsigned long usToMs(int64_t us);
+
+// Nachkommastellen (Sekunden), die eine Fehlergrenze noch trägt; -1 = unbekannt
+uint8_t durationDecimals(int64_t errorUs);
+
+int64_t getLastTime();
+int64_t getLastTimeErrorUs();
+void setLastTime(int64_t duration, int64_t errorUs = -1);
+void calcLastTime(int64_t startTime, int64_t endTime);
+#endif
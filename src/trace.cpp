@@ -0,0 +1,124 @@
+#include <trace.h>
+#include <Arduino.h>
+#include <Sensor.h>
+
+static TraceSample *traceRing = NULL;
+static volatile bool traceRecording = false;
+static volatile uint32_t traceHead = 0; // Anzahl geschriebener Samples seit Start
+static volatile uint8_t traceExports = 0; // Laufende Exporte, der Ring bleibt bis dahin stehen
+
+bool startTrace()
+{
+    if (traceExports > 0)
+        return false;
+    if (traceRing == NULL)
+    {
+        traceRing = (TraceSample *)malloc(sizeof(TraceSample) * TRACE_CAPACITY);
+        if (traceRing == NULL)
+        {
+            Serial.printf("[TRACE] Kein Speicher für %d Samples\n", TRACE_CAPACITY);
+            return false;
+        }
+    }
+    traceHead = 0;
+    traceRecording = true;
+    Serial.printf("[TRACE] Aufzeichnung gestartet (%d Samples, %u Bytes)\n", TRACE_CAPACITY, (unsigned)(sizeof(TraceSample) * TRACE_CAPACITY));
+    return true;
+}
+
+void stopTrace()
+{
+    if (traceRecording)
+    {
+        // Ein Schreibzugriff des Sensor-Tasks kann noch laufen; er trifft höchstens
+        // den Slot traceHead, den der Export bei vollem Ring auslässt
+        traceRecording = false;
+        Serial.printf("[TRACE] Aufzeichnung gestoppt, %lu Samples\n", (unsigned long)traceHead);
+    }
+}
+
+void recordTraceSample(uint8_t channel, int64_t timeUs, float distance)
+{
+    if (!traceRecording)
+        return;
+
+    TraceSample &s = traceRing[traceHead % TRACE_CAPACITY];
+    s.timeUs = timeUs;
+    s.distance = distance;
+    s.channel = channel;
+    traceHead = traceHead + 1;
+}
+
+TraceExport::TraceExport() : line(0), next(0), end(0), pendingLen(0), pendingPos(0)
+{
+    traceExports++;
+    stopTrace();
+    if (traceRing == NULL)
+        return;
+
+    uint32_t head = traceHead;
+    uint32_t count = head < TRACE_CAPACITY ? head : TRACE_CAPACITY - 1;
+    next = head - count;
+    end = head;
+}
+
+TraceExport::~TraceExport()
+{
+    traceExports--;
+}
+
+// Kopfzeilen mit der aktuellen Konfiguration, damit das Replay ohne Parameter auskommt
+int TraceExport::formatLine(char *out, size_t size)
+{
+    uint8_t channels = getSensorChannelCount();
+    uint32_t current = line++;
+    if (current == 0)
+    {
+        FilterConfig cfg = getCurrentFilterConfig();
+        return snprintf(out, size, "# lichtschranke trace v1\n# filter=%s window=%d k=%.2f hysteresis=%.1f confirm=%d cooldown_us=%lld\n",
+                        filterModeToString(cfg.mode), cfg.window, cfg.hampelK, cfg.hysteresisCm, cfg.confirmSamples, (long long)COOLDOWN_US);
+    }
+    if (current <= channels)
+        return snprintf(out, size, "# channel=%d min=%d max=%d\n", current - 1, getCurrentMinDistance(current - 1), getCurrentMaxDistance(current - 1));
+    if (current == channels + 1u)
+        return snprintf(out, size, "channel,time_us,distance_cm\n");
+    if (next == end)
+        return 0;
+
+    const TraceSample &s = traceRing[next++ % TRACE_CAPACITY];
+    return snprintf(out, size, "%d,%lld,%.2f\n", s.channel, (long long)s.timeUs, s.distance);
+}
+
+size_t TraceExport::read(uint8_t *buffer, size_t maxLen)
+{
+    size_t written = 0;
+    while (written < maxLen)
+    {
+        if (pendingPos == pendingLen)
+        {
+            int n = formatLine(pending, sizeof(pending));
+            if (n <= 0)
+                break;
+            pendingLen = n < (int)sizeof(pending) ? n : sizeof(pending) - 1;
+            pendingPos = 0;
+        }
+        size_t chunk = pendingLen - pendingPos;
+        if (chunk > maxLen - written)
+            chunk = maxLen - written;
+        memcpy(buffer + written, pending + pendingPos, chunk);
+        pendingPos += chunk;
+        written += chunk;
+    }
+    return written;
+}
+
+TraceStatus getTraceStatus()
+{
+    TraceStatus st;
+    uint32_t head = traceHead;
+    st.recording = traceRecording;
+    st.capacity = TRACE_CAPACITY;
+    st.count = head < TRACE_CAPACITY ? head : TRACE_CAPACITY;
+    st.dropped = head - st.count;
+    return st;
+}
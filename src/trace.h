@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Aufzeichnung roher Sensor-Samples für das Replay-Werkzeug (tools/replay)
+
+#ifndef TRACE_CAPACITY
+#define TRACE_CAPACITY 2048 // Samples im RAM-Ring, ältere werden überschrieben
+#endif
+
+struct TraceSample
+{
+    int64_t timeUs; // Messzeitpunkt (µs)
+    float distance; // Rohdistanz in cm, MAX_DISTANCE_CM = kein Echo
+    uint8_t channel;
+};
+
+struct TraceStatus
+{
+    bool recording;
+    uint32_t count;    // Samples im Ring
+    uint32_t capacity;
+    uint32_t dropped;  // Überschriebene Samples
+};
+
+// Ring wird beim ersten Start einmalig angelegt; false auch während eines Exports
+bool startTrace();
+void stopTrace();
+
+// Aus dem Sensor-Task, nur ein Speicherzugriff wenn die Aufzeichnung läuft
+void recordTraceSample(uint8_t channel, int64_t timeUs, float distance);
+
+// CSV-Export direkt aus dem RAM-Ring, Zeile für Zeile für eine Chunked-Response:
+// kein Flash-Schreiben, kein Blockieren im Webserver-Task. Der Konstruktor stoppt
+// die Aufzeichnung, solange ein Export lebt, startet keine neue.
+class TraceExport
+{
+public:
+    TraceExport();
+    ~TraceExport();
+    bool empty() const { return next == end; }
+
+    // Füllt buffer mit bis zu maxLen Bytes, 0 = fertig
+    size_t read(uint8_t *buffer, size_t maxLen);
+
+private:
+    int formatLine(char *line, size_t size);
+
+    uint32_t line; // Laufende Zeile (Kopf, Kanäle, Spalten, dann Samples)
+    uint32_t next; // Nächstes Sample (Zähler wie traceHead)
+    uint32_t end;
+    char pending[160];
+    uint16_t pendingLen;
+    uint16_t pendingPos;
+};
+
+TraceStatus getTraceStatus();
+
+#endif
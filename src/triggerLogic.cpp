@@ -0,0 +1,73 @@
+#include <triggerLogic.h>
+
+void resetTrigger(TriggerState &st)
+{
+    st.status = STATUS_NORMAL;
+    st.lastTrigger = 0;
+    st.cooldownUntil = 0;
+}
+
+MeasureResult evaluateSample(DistanceFilter &f, const FilterConfig &cfg, uint8_t channel,
+                             float dist, int64_t timeUs, float minCm, float maxCm)
+{
+    MeasureResult res;
+    if (dist == 0)
+    {
+        dist = MAX_DISTANCE_CM;
+    }
+    res.time = timeUs;
+    res.channel = channel;
+    res.distance = dist;
+    res.echo = dist < MAX_DISTANCE_CM;
+
+    // Trigger-Entscheidung über das gleitende Fenster statt über ein einzelnes Echo
+    res.triggered = filterSample(f, cfg, dist, timeUs, minCm, maxCm);
+    res.triggerTime = f.runStartUs;
+    res.triggerErrorUs = f.runErrorUs;
+    return res;
+}
+
+TriggerStep stepTrigger(TriggerState &st, const MeasureResult &res, int64_t cooldownUs)
+{
+    TriggerStep step;
+    step.fired = false;
+    step.cooldownRejected = false;
+    step.prevStatus = st.status;
+
+    if (res.triggered && st.status == STATUS_NORMAL && res.time >= st.cooldownUntil)
+    {
+        // Interpolierter Schwellen-Durchgang: weder Filterverzögerung noch Abtastperiode gehen in die Zeit ein
+        step.fired = true;
+        st.lastTrigger = res.triggerTime;
+        st.status = STATUS_TRIGGERED;
+    }
+    // Optimierte Status-Maschine mit weniger Vergleichen
+    else if (!res.triggered)
+    {
+        if (st.status == STATUS_TRIGGERED || st.status == STATUS_TRIGGERED_IN_COOLDOWN)
+        {
+            st.status = STATUS_COOLDOWN;
+            st.cooldownUntil = res.time + cooldownUs;
+        }
+        else if (st.status == STATUS_COOLDOWN && res.time >= st.cooldownUntil)
+        {
+            st.status = STATUS_NORMAL;
+        }
+    }
+    else
+    {
+        if (st.status == STATUS_COOLDOWN || st.status == STATUS_TRIGGERED_IN_COOLDOWN)
+        {
+            step.cooldownRejected = (st.status == STATUS_COOLDOWN);
+            st.status = STATUS_TRIGGERED_IN_COOLDOWN;
+            st.cooldownUntil = res.time + cooldownUs;
+        }
+        else if (st.status == STATUS_TRIGGERED && (res.time - st.lastTrigger > TRIGGER_STUCK_US))
+        {
+            st.status = STATUS_COOLDOWN;
+            st.cooldownUntil = res.time + cooldownUs;
+        }
+    }
+
+    return step;
+}
@@ -0,0 +1,39 @@
+#ifndef TRIGGER_LOGIC_H
+#define TRIGGER_LOGIC_H
+
+#include <stdint.h>
+#include <Sensor.h>
+
+// Plattformunabhängig (kein Arduino.h): Firmware und Replay-Werkzeug
+// (tools/replay) treffen mit demselben Code dieselben Entscheidungen
+
+// Dauerhaft belegter Sensor wird nach dieser Zeit in den Cooldown gezwungen
+#ifndef TRIGGER_STUCK_US
+#define TRIGGER_STUCK_US 500000
+#endif
+
+// Status-Maschine eines Sensor-Kanals
+struct TriggerState
+{
+    LichtschrankeStatus status;
+    int64_t lastTrigger;   // µs
+    int64_t cooldownUntil; // µs
+};
+
+struct TriggerStep
+{
+    bool fired;            // Neue Auslösung, Zeitpunkt in res.triggerTime
+    bool cooldownRejected; // Neue Belegung während des Cooldowns verworfen
+    LichtschrankeStatus prevStatus;
+};
+
+void resetTrigger(TriggerState &st);
+
+// Filtert ein Roh-Sample und liefert das Messergebnis wie measure()
+MeasureResult evaluateSample(DistanceFilter &f, const FilterConfig &cfg, uint8_t channel,
+                             float dist, int64_t timeUs, float minCm, float maxCm);
+
+// Ein Schritt der Status-Maschine für ein Messergebnis
+TriggerStep stepTrigger(TriggerState &st, const MeasureResult &res, int64_t cooldownUs);
+
+#endif
@@ -0,0 +1,179 @@
+// Host-Prüfung des Uhrenmodells (src/clockSync.cpp) mit synthetischen Uhren.
+// Simuliert Geräte mit festem Offset und Drift gegenüber der Referenz, tauscht
+// Bursts mit zufälligen Funklaufzeiten aus und prüft Drift-Schätzung,
+// Fehlergrenze, Umkehrung und die Verkettung bei der Standby-Übernahme.
+//
+// Bauen und Ausführen (im Projektverzeichnis):
+//   g++ -std=c++17 -O2 -Isrc tools/clocksim/clocksim.cpp src/clockSync.cpp -o clocksim && ./clocksim
+// Rückgabewert 0 = alle Prüfungen bestanden.
+
+#include <clockSync.h>
+#include <stdio.h>
+#include <math.h>
+
+// Uhr eines Geräts: lokal = ref * (1 + drift) + offset (ref = Zeit der Referenz)
+struct SimClock
+{
+    double driftPpm;
+    double offsetUs;
+
+    int64_t localAt(double refUs) const { return (int64_t)llround(refUs * (1.0 + driftPpm * 1e-6) + offsetUs); }
+    double refAt(int64_t localUs) const { return ((double)localUs - offsetUs) / (1.0 + driftPpm * 1e-6); }
+
+    // Gangabweichung der Referenz gegenüber lokal, wie ClockModel::skewPpm
+    double expectedSkewPpm() const { return -driftPpm / (1.0 + driftPpm * 1e-6); }
+};
+
+// Deterministischer Zufall, damit Läufe vergleichbar bleiben
+static uint32_t rngState = 12345;
+static double uniform()
+{
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) / 16777216.0;
+}
+
+// Einfache Laufzeit mit Grundlaufzeit, Streuung und gelegentlicher Warteschlange
+static double radioDelayUs()
+{
+    double delay = 800.0 + 400.0 * uniform();
+    if (uniform() < 0.2)
+        delay += 3000.0 + 10000.0 * uniform();
+    return delay;
+}
+
+// Ein Burst wie syncTimeWithMaster: CLOCK_BURST_SIZE Austausche im Abstand von 15 ms
+static void runBurst(ClockModel &m, const SimClock &dev, double refUs, uint32_t sequence)
+{
+    ClockBurst b;
+    startClockBurst(b, sequence);
+    for (int i = 0; i < CLOCK_BURST_SIZE; i++)
+    {
+        double sendRef = refUs + i * 15000.0;
+        int64_t t1 = dev.localAt(sendRef);
+        double t2 = sendRef + radioDelayUs();
+        double t3 = t2 + 150.0; // Bearbeitung bei der Referenz
+        int64_t t4 = dev.localAt(t3 + radioDelayUs());
+        addClockExchange(b, t1, (int64_t)llround(t2), (int64_t)llround(t3), t4);
+    }
+    finishClockBurst(m, b);
+}
+
+static ClockModel syncedModel(const SimClock &dev, int bursts, double intervalUs, double startRefUs = 1e6)
+{
+    ClockModel m;
+    resetClockModel(m);
+    for (int i = 0; i < bursts; i++)
+        runBurst(m, dev, startRefUs + i * intervalUs, i + 1);
+    return m;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("%s  %s\n", ok ? "OK    " : "FEHLER", what);
+    if (!ok)
+        failures++;
+}
+
+// Fehlergrenze muss die tatsächliche Abweichung bis maxAgeUs nach dem Bezugspunkt abdecken
+static bool boundHolds(const ClockModel &m, const SimClock &dev, double fromRefUs, double maxAgeUs, int64_t &worstUs)
+{
+    bool ok = true;
+    worstUs = 0;
+    for (double age = 0; age <= maxAgeUs; age += maxAgeUs / 20)
+    {
+        int64_t local = dev.localAt(fromRefUs + age);
+        int64_t error = llabs(clockToReference(m, local) - (int64_t)llround(dev.refAt(local)));
+        if (error > worstUs)
+            worstUs = error;
+        if (error > clockErrorAt(m, local))
+            ok = false;
+    }
+    return ok;
+}
+
+int main()
+{
+    char text[160];
+    int64_t worst;
+
+    // 1) Drift-Schätzung nach mehreren Bursts im 30-s-Takt
+    const double drifts[] = {-80.0, -12.5, 0.0, 35.0, 150.0};
+    for (double drift : drifts)
+    {
+        SimClock dev = {drift, 250000.0};
+        ClockModel m = syncedModel(dev, 8, 30e6);
+        double lastRef = 1e6 + 7 * 30e6;
+        double skewError = fabs(m.skewPpm - dev.expectedSkewPpm());
+
+        snprintf(text, sizeof(text), "Drift %.1f ppm: geschätzt %.2f ppm (±%.2f), Abweichung %.2f ppm",
+                 drift, m.skewPpm, m.skewErrorPpm, skewError);
+        check(m.skewValid && skewError <= 2.0, text);
+
+        bool bound = boundHolds(m, dev, lastRef, 120e6, worst);
+        snprintf(text, sizeof(text), "Drift %.1f ppm: Fehlergrenze hält 120 s, größte Abweichung %lld us (Grenze dann %lld us)",
+                 drift, (long long)worst, (long long)clockErrorAt(m, dev.localAt(lastRef + 120e6)));
+        check(bound, text);
+
+        int64_t local = dev.localAt(lastRef + 45e6);
+        int64_t roundTrip = clockFromReference(m, clockToReference(m, local)) - local;
+        snprintf(text, sizeof(text), "Drift %.1f ppm: clockFromReference kehrt um (Rest %lld us)", drift, (long long)roundTrip);
+        check(llabs(roundTrip) <= 1, text);
+    }
+
+    // 2) Vor der Drift-Schätzung: Standard-Unsicherheit muss eine echte Drift abdecken
+    {
+        SimClock dev = {40.0, -1800000.0};
+        ClockModel m = syncedModel(dev, 1, 30e6);
+        check(!m.skewValid && m.skewErrorPpm == CLOCK_DEFAULT_DRIFT_PPM, "Ein Burst: Drift noch nicht geschätzt, Standard-Unsicherheit");
+        bool bound = boundHolds(m, dev, 1e6, 30e6, worst);
+        snprintf(text, sizeof(text), "Ein Burst: Fehlergrenze hält 30 s bei 40 ppm, größte Abweichung %lld us", (long long)worst);
+        check(bound, text);
+    }
+
+    // 3) Unplausible Drift wird verworfen statt übernommen
+    {
+        SimClock dev = {400.0, 0.0};
+        ClockModel m = syncedModel(dev, 8, 30e6);
+        check(!m.skewValid && m.skewPpm == 0.0, "Drift über CLOCK_MAX_SKEW_PPM wird verworfen");
+    }
+
+    // 4) Übernahme: Gerät D -> alter Master A, neuer Master L -> A, verkettet D -> L
+    {
+        SimClock dev = {25.0, 5000000.0};     // Slave, Modell beim alten Master (ClockReport)
+        SimClock local = {-60.0, -3000000.0}; // Standby, eigenes Modell zum alten Master
+        ClockModel inner = syncedModel(dev, 8, 30e6);
+        ClockModel viaLocal = syncedModel(local, 8, 30e6, 4e6);
+        ClockModel chained = chainClockModel(inner, viaLocal);
+
+        // Erwartete Drift von L gegenüber D
+        double expectedPpm = ((1.0 + local.driftPpm * 1e-6) / (1.0 + dev.driftPpm * 1e-6) - 1.0) * 1e6;
+        snprintf(text, sizeof(text), "Verkettung: Drift %.2f ppm, erwartet %.2f ppm", chained.skewPpm, expectedPpm);
+        check(chained.valid && chained.skewValid && fabs(chained.skewPpm - expectedPpm) <= 3.0, text);
+
+        bool ok = true;
+        worst = 0;
+        double lastRef = 4e6 + 7 * 30e6;
+        for (double age = 0; age <= 120e6; age += 6e6)
+        {
+            int64_t devLocal = dev.localAt(lastRef + age);
+            int64_t truth = local.localAt(dev.refAt(devLocal));
+            int64_t error = llabs(clockToReference(chained, devLocal) - truth);
+            if (error > worst)
+                worst = error;
+            if (error > clockErrorAt(chained, devLocal))
+                ok = false;
+        }
+        snprintf(text, sizeof(text), "Verkettung: Fehlergrenze hält 120 s, größte Abweichung %lld us (Grenze am Bezugspunkt %lld us)",
+                 (long long)worst, (long long)chained.baseErrorUs);
+        check(ok, text);
+
+        ClockModel invalid;
+        resetClockModel(invalid);
+        check(!chainClockModel(inner, invalid).valid, "Verkettung ohne Modell des alten Masters bleibt ungültig");
+    }
+
+    printf("%s: %d Fehler\n", failures ? "FEHLGESCHLAGEN" : "BESTANDEN", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// Replay aufgezeichneter Sensor-Traces (GET /trace/download) auf dem Host.
+// Nutzt dieselbe Filter- und Status-Logik wie die Firmware.
+//
+// Bauen (im Projektverzeichnis):
+//   g++ -std=c++17 -O2 -Isrc tools/replay/replay.cpp src/sensorFilter.cpp src/triggerLogic.cpp -o replay
+//
+// Aufruf:
+//   ./replay trace.csv [--min CM] [--max CM] [--filter none|median|hampel] [--window N]
+//                      [--k K] [--hysteresis CM] [--confirm N] [--cooldown-ms MS] [--quiet]
+// Ohne Optionen gelten die Werte aus den Kopfzeilen der Aufzeichnung.
+
+#include <triggerLogic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ChannelReplay
+{
+    int minDistance;
+    int maxDistance;
+    DistanceFilter filter;
+    TriggerState trigger;
+    uint32_t samples;
+    uint32_t timeouts;
+    uint32_t triggers;
+    uint32_t cooldownRejections;
+    int64_t latencySumUs; // Durchgang bis Entscheidung
+    int64_t maxLatencyUs;
+};
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Verwendung: %s trace.csv [--min CM] [--max CM] [--filter none|median|hampel] [--window N]\n"
+                    "           [--k K] [--hysteresis CM] [--confirm N] [--cooldown-ms MS] [--quiet]\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "r");
+    if (!in)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    ChannelReplay channels[SENSOR_CHANNELS_MAX];
+    memset(channels, 0, sizeof(channels));
+    for (int i = 0; i < SENSOR_CHANNELS_MAX; i++)
+    {
+        channels[i].minDistance = 2;
+        channels[i].maxDistance = 100;
+        resetFilter(channels[i].filter);
+        resetTrigger(channels[i].trigger);
+    }
+    FilterConfig cfg = defaultFilterConfig();
+    int64_t cooldownUs = COOLDOWN_US;
+
+    // Kopfzeilen liefern die Konfiguration der Aufzeichnung, Optionen überschreiben sie
+    char line[256];
+    long dataStart = 0;
+    while (fgets(line, sizeof(line), in))
+    {
+        if (line[0] != '#')
+            break;
+        dataStart = ftell(in);
+
+        char mode[16];
+        int window, confirm, channel, minCm, maxCm;
+        float k, hysteresis;
+        long long cooldown;
+        if (sscanf(line, "# filter=%15s window=%d k=%f hysteresis=%f confirm=%d cooldown_us=%lld",
+                   mode, &window, &k, &hysteresis, &confirm, &cooldown) == 6)
+        {
+            cfg.mode = stringToFilterMode(mode);
+            cfg.window = window;
+            cfg.hampelK = k;
+            cfg.hysteresisCm = hysteresis;
+            cfg.confirmSamples = confirm;
+            cooldownUs = cooldown;
+        }
+        else if (sscanf(line, "# channel=%d min=%d max=%d", &channel, &minCm, &maxCm) == 3 &&
+                 channel >= 0 && channel < SENSOR_CHANNELS_MAX)
+        {
+            channels[channel].minDistance = minCm;
+            channels[channel].maxDistance = maxCm;
+        }
+    }
+
+    bool quiet = false;
+    int overrideMin = -1, overrideMax = -1;
+    for (int i = 2; i < argc; i++)
+    {
+        const char *opt = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(opt, "--quiet") == 0)
+        {
+            quiet = true;
+            continue;
+        }
+        if (value == NULL)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(opt, "--min") == 0)
+            overrideMin = atoi(value);
+        else if (strcmp(opt, "--max") == 0)
+            overrideMax = atoi(value);
+        else if (strcmp(opt, "--filter") == 0)
+            cfg.mode = stringToFilterMode(value);
+        else if (strcmp(opt, "--window") == 0)
+            cfg.window = atoi(value);
+        else if (strcmp(opt, "--k") == 0)
+            cfg.hampelK = atof(value);
+        else if (strcmp(opt, "--hysteresis") == 0)
+            cfg.hysteresisCm = atof(value);
+        else if (strcmp(opt, "--confirm") == 0)
+            cfg.confirmSamples = atoi(value);
+        else if (strcmp(opt, "--cooldown-ms") == 0)
+            cooldownUs = atoll(value) * 1000;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    sanitizeFilterConfig(cfg);
+    for (int i = 0; i < SENSOR_CHANNELS_MAX; i++)
+    {
+        if (overrideMin >= 0)
+            channels[i].minDistance = overrideMin;
+        if (overrideMax >= 0)
+            channels[i].maxDistance = overrideMax;
+    }
+
+    printf("# filter=%s window=%d k=%.2f hysteresis=%.1f confirm=%d cooldown_us=%lld\n",
+           filterModeToString(cfg.mode), cfg.window, cfg.hampelK, cfg.hysteresisCm, cfg.confirmSamples, (long long)cooldownUs);
+
+    fseek(in, dataStart, SEEK_SET);
+    int64_t firstTimeUs = 0;
+    while (fgets(line, sizeof(line), in))
+    {
+        int channel;
+        long long timeUs;
+        float distance;
+        if (sscanf(line, "%d,%lld,%f", &channel, &timeUs, &distance) != 3)
+            continue; // Spaltenüberschrift oder defekte Zeile
+        if (channel < 0 || channel >= SENSOR_CHANNELS_MAX)
+            continue;
+        if (firstTimeUs == 0)
+            firstTimeUs = timeUs;
+
+        ChannelReplay &ch = channels[channel];
+        MeasureResult res = evaluateSample(ch.filter, cfg, channel, distance, timeUs, ch.minDistance, ch.maxDistance);
+        TriggerStep step = stepTrigger(ch.trigger, res, cooldownUs);
+
+        ch.samples++;
+        if (!res.echo)
+            ch.timeouts++;
+        if (step.cooldownRejected)
+            ch.cooldownRejections++;
+        if (step.fired)
+        {
+            int64_t latency = res.time - res.triggerTime;
+            ch.triggers++;
+            ch.latencySumUs += latency;
+            if (latency > ch.maxLatencyUs)
+                ch.maxLatencyUs = latency;
+            if (!quiet)
+                printf("TRIGGER kanal=%d t=%.6fs latenz=%lldus distanz=%.1fcm\n",
+                       channel, (res.triggerTime - firstTimeUs) / 1e6, (long long)latency, res.distance);
+        }
+    }
+    fclose(in);
+
+    for (int i = 0; i < SENSOR_CHANNELS_MAX; i++)
+    {
+        const ChannelReplay &ch = channels[i];
+        if (ch.samples == 0)
+            continue;
+        printf("Kanal %d: min=%d max=%d samples=%u timeouts=%.1f%% trigger=%u cooldown-verworfen=%u latenz avg=%lldus max=%lldus\n",
+               i, ch.minDistance, ch.maxDistance, ch.samples, 100.0 * ch.timeouts / ch.samples, ch.triggers,
+               ch.cooldownRejections, (long long)(ch.triggers ? ch.latencySumUs / ch.triggers : 0), (long long)ch.maxLatencyUs);
+    }
+    return 0;
+}